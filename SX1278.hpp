@@ -8,32 +8,57 @@
 
 
 
+#include <cstdint>
+#include <utility>
+
 #include <etl/optional.h>
+#include <etl/span.h>
 
-#include "main.h"
+#include "SX1278_Airtime.hpp"
+#include "SX1278_Clock.hpp"
 #include "SX1278_ControlTable.hpp"
-#include "Utils/hw.hpp"
+#include "SX1278_FramePool.hpp"
+#include "SX1278_RegisterBatch.hpp"
 
-namespace radio::sx1278 {
-	struct PinoutConfig {
-		/** Pointer to HAL SPI handle **/
-		SPI_HandleTypeDef* spi_handle;
-		/** NSS pin **/
-		utils::GPIO_Pin NSS;
-		/** RESET pin **/
-		utils::GPIO_Pin RESET;
-		/** DIO pins **/
-		utils::GPIO_Pin DIO0;
-		// utils::GPIO_Pin DIO1;
-		// utils::GPIO_Pin DIO2;
-		// utils::GPIO_Pin DIO3;
-		// utils::GPIO_Pin DIO4;
-		// utils::GPIO_Pin DIO5;
-	};
+#ifdef SX1278_PROFILER
+#include "SX1278_Profiler.hpp"
+#endif
+
+#ifdef SX1278_COROUTINES
+#include "SX1278_Coroutine.hpp"
+#endif
 
+#ifdef SX1278_RX_RING
+#include "SX1278_RxRing.hpp"
+#endif
+
+namespace radio::sx1278 {
+	/**
+	 * Driver for the SX1278 LoRa transceiver.
+	 *
+	 * @tparam Transport Bus backend (see SX1278_HalTransport.hpp, SX1278_LLTransport.hpp, SX1278_MockTransport.hpp).
+	 *         It has to provide:
+	 *         - void select() / void deselect() - assert / release NSS,
+	 *         - bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length) - blocking full-duplex transfer,
+	 *         - bool write(const uint8_t* data, uint16_t length) - blocking transmit,
+	 *         - bool read(uint8_t* data, uint16_t length) - blocking receive,
+	 *         - void reset() - pulse the RESET pin and wait for the chip,
+	 *         and with SX1278_SPI_DMA also:
+	 *         - bool write_dma(const uint8_t* data, uint16_t length) / bool read_dma(uint8_t* data, uint16_t length),
+	 *         - void read_dma_complete(uint8_t* data, uint16_t length) - called once a DMA read has landed.
+	 *         For the non-blocking API it also has to provide:
+	 *         - bool transfer_async(const uint8_t* tx, uint8_t* rx, uint16_t length) - start an interrupt-driven
+	 *           transfer (tx or rx may be nullptr) and return true, or return false if it cannot, in which case the
+	 *           driver runs the transfer blocking,
+	 *         - uint32_t critical_enter() / void critical_exit(uint32_t state) - mask / restore the SPI interrupt.
+	 *         All calls are resolved at compile time, there is no virtual dispatch.
+	 *         The transport also names its default clock as Transport::clock.
+	 * @tparam Clock Tick source used for profiling and timing, see SX1278_Clock.hpp.
+	 */
+	template <typename Transport, typename Clock = typename Transport::clock>
 	class SX1278 {
 	public:
-		explicit SX1278(PinoutConfig pinout_config) : pinout_config(pinout_config) {};
+		explicit SX1278(Transport transport) : transport(transport) {};
 		~SX1278() = default;
 
 		/** Public methods **/
@@ -51,11 +76,49 @@ namespace radio::sx1278 {
 				uint8_t max_current = 100
 				);
 
-		void reset() const;
+		void reset();
+		Status resync();
+		void commit(RegisterBatch& batch);
+
+		uint32_t startTransmit(const uint8_t* data, uint8_t length);
+		etl::optional<uint32_t> startTransmit(etl::span<const etl::span<const uint8_t>> segments);
+		bool queueTransmit(const uint8_t* data, uint8_t length);
+		bool queueTransmit(FrameHandle&& frame);
+		uint8_t tx_queue_size() const;
+		bool retransmit();
+		bool is_fifo_tx_valid() const;
 
-		void startTransmit(uint8_t* data, uint8_t length);
+		bool prelock_transmit(const uint8_t* data, uint8_t length);
+		bool transmit_prelocked();
+
+		/** Start-up of the last transmission entered through set_mode(TX) **/
+		struct TxStartLatency {
+			/** measured: transmit call (or TxDone for queued frames) until the TX OpMode write left the bus, Clock ticks **/
+			uint32_t command_ticks;
+			/** estimated: modem start-up after that write until the preamble, datasheet typical PA ramp, plus PLL lock unless pre-locked **/
+			uint16_t startup_us;
+			bool prelocked;
+			/**
+			 * measured on TxDone: transmit call until the preamble started, i.e. the DIO0 time minus the computed time
+			 * on air, Clock ticks; only as exact as the DIO0 timestamp, so capture it (on_dio0_irq(captured_ticks))
+			 **/
+			int32_t start_ticks;
+		};
+		TxStartLatency get_tx_start_latency() const { return _tx_latency; }
+
+		/** Airtime with the current modem settings, see SX1278_Airtime.hpp **/
+		uint32_t get_time_on_air_us(uint8_t length) const;
+		uint32_t get_symbol_time_us() const;
+		/** Clock time at which the last transmission entered through set_mode(TX) is expected to raise TxDone **/
+		uint32_t get_tx_done_time() const { return _tx_done_ticks; }
+
+		bool set_fifo_slots(uint8_t count, uint8_t size);
+		bool stage_frame(uint8_t slot, const uint8_t* data, uint8_t length);
+		bool patch_frame(uint8_t slot, uint8_t offset, const uint8_t* data, uint8_t length);
+		bool transmit_staged(uint8_t slot);
 		void startReceive();
 		uint8_t getReceivedData(uint8_t* data, uint8_t length = 0);
+		FrameHandle getReceivedFrame(FramePoolBase& pool, uint8_t length = 0);
 
 		void set_frequency(uint32_t frequency);
 		void set_power(lora::Power power);
@@ -69,23 +132,82 @@ namespace radio::sx1278 {
 		void set_ocp(uint8_t max_current);
 		void set_header_mode(lora::HeaderMode header_mode);
 		void set_lna_gain(lora::LNAGain lna_gain);
+		void set_modem_config(
+				lora::SpreadingFactor spreading_factor,
+				lora::Bandwidth bandwidth,
+				lora::CodingRate coding_rate,
+				lora::HeaderMode header_mode,
+				lora::PayloadCRC crc
+				);
 
 		int get_RSSI();
+		lora::PacketStatus get_packet_status() const { return _rx_status; }
+		/** RegIrqFlags of the last receive: RxDone missing, PayloadCrcError, or RxDone alone if the length was unknown **/
+		uint8_t get_rx_irq_flags() const { return _rx_irq_flags; }
 		uint8_t get_version();
 		lora::Mode get_mode();
+		Transport& get_transport() { return transport; }
 		void on_dio0_irq();
+		void on_dio0_irq(uint32_t captured_ticks);
+
+		/** RxDone / TxDone time of the last packet received from on_dio0_irq() / the last transmission **/
+		EventTime get_rx_time() const { return _rx_time; }
+		EventTime get_tx_time() const { return _tx_time; }
 
 		void(*on_rx)(void) = nullptr;
+		/** Called from TxDone of every transmission, before the next queued frame is started **/
+		void(*on_tx_done)(const EventTime& time) = nullptr;
+
+		/** Non-blocking variants; they only queue SPI transactions and return false if the queue is full **/
+		bool startTransmitAsync(const uint8_t* data, uint8_t length, void(*on_loaded)(void) = nullptr);
+		bool startReceiveAsync();
+		bool getReceivedDataAsync(uint8_t* data, uint8_t length, void(*on_data)(uint8_t* data, uint8_t length));
+
+		/** Must be called from the SPI transfer complete interrupt (HAL_SPI_TxCpltCallback, RxCpltCallback, TxRxCpltCallback) **/
+		void on_spi_complete();
+		bool is_spi_idle() const;
+
+#ifdef SX1278_RX_RING
+		/** Frames drained on RxDone, consumed by the application; on_rx only notifies then **/
+		RxRing<SX1278_RX_RING_SLOTS>& rx_ring() { return _rx_ring; }
+#endif
+
+#ifdef SX1278_PROFILER
+		/** Per-register bus usage of the blocking SPI helpers, times in Clock ticks **/
+		BusProfiler& profiler() { return _profiler; }
+#endif
+
+#ifdef SX1278_COROUTINES
+		/** Awaitables for Task coroutines, resumed from on_dio0_irq() / on_spi_complete() **/
+		TransmitAwaiter<SX1278> transmit(etl::span<const uint8_t> data);
+		ReceiveAwaiter<SX1278> receive(etl::span<uint8_t> buffer, uint32_t deadline);
+		CadAwaiter<SX1278> cad();
+
+		/** Expires a pending receive() once now reaches its deadline; call periodically with the same time base **/
+		void on_tick(uint32_t now);
+#endif
+
+#ifdef SX1278_SPI_DMA
+		/** Called by on_spi_complete() while a FIFO DMA transfer is pending **/
+		void on_spi_dma_complete();
+		bool is_dma_busy() const;
+
+		/** Called from DMA completion once a FIFO drain started by getReceivedData has landed in the buffer **/
+		void(*on_rx_data)(uint8_t* data, uint8_t length) = nullptr;
+		/** Called from DMA completion with the frame of getReceivedFrame(), length set; released if not set **/
+		void(*on_rx_frame)(FrameHandle&& frame) = nullptr;
+#endif
 	private:
 		/** Hardware **/
-		PinoutConfig pinout_config;
+		Transport transport;
 
 		/** Module settings **/
 		lora::Mode _current_mode;
 		uint32_t _frequency;
 		lora::Power _power;
-		lora::SpreadingFactor _spreading_factor;
-		lora::Bandwidth _bandwidth;
+		/** chip reset values, so setters may derive LowDataRateOptimize before init() has set both **/
+		lora::SpreadingFactor _spreading_factor = lora::SpreadingFactor::SF_7;
+		lora::Bandwidth _bandwidth = lora::Bandwidth::BW_125_KHZ;
 		lora::CodingRate _coding_rate;
 		lora::HeaderMode _header_mode;
 		lora::LNAGain _lna_gain;
@@ -94,9 +216,200 @@ namespace radio::sx1278 {
 		uint16_t _timeout;
 		uint8_t _max_current;
 
+		/** Shadow of the configuration registers; setters modify it and write it out without reading the chip **/
+		struct RegisterShadow {
+			uint8_t op_mode;
+			uint8_t pa_config;
+			uint8_t lna;
+			uint8_t modem_config1;
+			uint8_t modem_config2;
+			uint8_t modem_config3;
+			uint8_t detect_optimize;
+			uint8_t dio_mapping1;
+			uint8_t dio_mapping2;
+		};
+		RegisterShadow _shadow{};
+
+#ifdef SX1278_PROFILER
+		BusProfiler _profiler;
+#endif
+
+		/** RegIrqFlags, packet SNR and RSSI as read by the last getReceivedData() / getReceivedDataAsync() **/
+		uint8_t _rx_irq_flags = 0;
+		lora::PacketStatus _rx_status{};
+
+		/** RX status burst: RegFiFoRxCurrentAddr (0x10) .. RegPktRssiValue (0x1A) **/
+		static constexpr uint8_t rx_status_length = 11;
+		void decode_rx_status(const uint8_t (&status)[rx_status_length]);
+
+		/** Clock time of the last DIO0 edge, taken first thing in on_dio0_irq() **/
+		volatile uint32_t _dio0_ticks = 0;
+		EventTime _rx_time{};
+		EventTime _tx_time{};
+		EventTime event_time(uint32_t done, uint8_t length) const;
+		void update_low_data_rate_optimize();
+		/** LowDataRateOptimize as configured in the chip, used by every airtime computation **/
+		bool low_data_rate() const { return _shadow.modem_config3 & 0x08; }
+
+#ifdef SX1278_RX_RING
+		RxRing<SX1278_RX_RING_SLOTS> _rx_ring;
+		/** a ring slot is being filled by a FIFO DMA drain, published from on_spi_dma_complete() **/
+		bool _rx_ring_draining = false;
+
+		void rx_ring_drain();
+		void rx_ring_publish(uint8_t length);
+#endif
+
+		/** Batch collecting configuration writes, nullptr when they go straight to the bus **/
+		RegisterBatch* _batch = nullptr;
+
 		void _handle_txdone_irq();
 		void _handle_rxdone_irq();
 
+		/** Frames waiting for TxDone, sent back to back without returning to RX; data is not copied **/
+		struct TxFrame {
+			const uint8_t* data;
+			uint8_t length;
+			/** owner of data for frames queued by handle, empty otherwise **/
+			FrameHandle frame;
+		};
+
+		bool enqueue_transmit(const uint8_t* data, uint8_t length, FrameHandle& frame);
+
+		static constexpr uint8_t tx_queue_depth = 8;
+		TxFrame _tx_queue[tx_queue_depth]{};
+		volatile uint8_t _tx_head = 0;
+		volatile uint8_t _tx_count = 0;
+		/** a queued frame is on air, the next one is loaded from _handle_txdone_irq() **/
+		volatile bool _tx_active = false;
+		/** pool buffer of the frame on air, released on its TxDone **/
+		FrameHandle _tx_on_air;
+
+		/** The FIFO still holds the last transmitted payload at RegFifoTxBaseAddr, see retransmit() **/
+		volatile bool _fifo_tx_valid = false;
+
+		/**
+		 * FIFO layout: staged TX slots from 0x00, then the RX region, which also takes frames loaded on the fly.
+		 * Slot lengths of 0 mark empty slots.
+		 */
+		static constexpr uint8_t fifo_max_slots = 8;
+		uint8_t _fifo_slot_count = 0;
+		uint8_t _fifo_slot_size = 0;
+		uint8_t _fifo_slot_length[fifo_max_slots]{};
+		uint8_t _fifo_rx_base = 0;
+		/** shadow of RegFifoTxBaseAddr **/
+		uint8_t _fifo_tx_base = 0;
+
+		/** Time base of TxStartLatency, taken when a transmission is requested **/
+		uint32_t _tx_request_ticks = 0;
+		TxStartLatency _tx_latency{};
+		/** payload length of the frame set up for TX and its expected TxDone time **/
+		uint8_t _tx_length = 0;
+		uint32_t _tx_done_ticks = 0;
+
+		/** Datasheet typical start-up times: PLL lock (TS_FS) and the reset value of RegPaRamp (40 us) **/
+		static constexpr uint16_t pll_lock_us = 60;
+		static constexpr uint16_t pa_ramp_us = 40;
+
+		bool claim_tx_area(uint8_t length);
+		void tx_started(bool prelocked);
+		void prepare_tx_fifo(uint8_t length);
+		void load_and_transmit(const uint8_t* data, uint8_t length);
+		void drop_fifo_contents();
+		void write_fifo_standby(uint8_t address, const uint8_t* data, uint8_t length);
+
+		/** Asynchronous SPI engine: one queued NSS transaction (address phase, then optional payload phase) **/
+		struct SpiTransaction {
+			/** address byte, followed by the value for single register writes **/
+			uint8_t header[2];
+			/** bytes clocked in during the address phase, a single register read lands in header_rx[1] **/
+			uint8_t header_rx[2];
+			uint8_t header_length;
+			const uint8_t* tx_payload;
+			uint8_t* rx_payload;
+			uint8_t payload_length;
+			/** completion hook, called with NSS released **/
+			void (SX1278::*on_complete)(const SpiTransaction& transaction);
+		};
+
+		static constexpr uint8_t spi_queue_depth = 16;
+		SpiTransaction _spi_queue[spi_queue_depth]{};
+		volatile uint8_t _spi_head = 0;
+		volatile uint8_t _spi_count = 0;
+		/** slots set aside for transactions queued later from a hook or IRQ handler, see spi_reserve() **/
+		volatile uint8_t _spi_reserved = 0;
+		volatile bool _spi_busy = false;
+		bool _spi_payload_phase = false;
+
+		/** State of the non-blocking transmit/receive in flight **/
+		void(*_async_on_loaded)(void) = nullptr;
+		/** payload length of the queued transmission, becomes _tx_length once it is in TX mode **/
+		uint8_t _async_tx_length = 0;
+		void(*_async_on_data)(uint8_t* data, uint8_t length) = nullptr;
+		uint8_t* _async_rx_data = nullptr;
+		uint8_t _async_rx_length = 0;
+		uint8_t _async_irq_flags = 0;
+		/** RegFiFoRxCurrentAddr .. RegPktRssiValue, read in one burst **/
+		uint8_t _async_rx_status[rx_status_length]{};
+		/** FifoAddrPtr write, FIFO burst and IRQ clear queued by the status hook, reserved up front **/
+		static constexpr uint8_t rx_drain_slots = 3;
+
+		uint8_t spi_queue_free() const;
+		void spi_reserve(uint8_t slots);
+		void spi_unreserve(uint8_t slots);
+		void spi_enqueue(const SpiTransaction& transaction);
+		bool spi_start_phase(SpiTransaction& transaction);
+		void spi_advance();
+
+		template <typename RegAddr>
+		void queue_write(RegAddr addr, uint8_t value, void (SX1278::*on_complete)(const SpiTransaction&) = nullptr);
+		template <typename RegAddr>
+		void queue_read(RegAddr addr, void (SX1278::*on_complete)(const SpiTransaction&));
+		template <typename RegAddr>
+		void queue_burst_write(RegAddr addr, const uint8_t* data, uint8_t length, void (SX1278::*on_complete)(const SpiTransaction&) = nullptr);
+		template <typename RegAddr>
+		void queue_burst_read(RegAddr addr, uint8_t* data, uint8_t length, void (SX1278::*on_complete)(const SpiTransaction&) = nullptr);
+		void queue_mode(lora::Mode mode, void (SX1278::*on_complete)(const SpiTransaction&) = nullptr);
+
+		void _async_tx_loaded(const SpiTransaction& transaction);
+		void _async_rx_status_read(const SpiTransaction& transaction);
+		void _async_rx_finished(const SpiTransaction& transaction);
+		void _async_rx_complete(uint8_t length);
+
+#ifdef SX1278_COROUTINES
+		template <typename> friend struct TransmitAwaiter;
+		template <typename> friend struct ReceiveAwaiter;
+		template <typename> friend struct CadAwaiter;
+
+		enum class CoroOperation : uint8_t {
+			NONE,
+			TRANSMIT,
+			RECEIVE,
+			CAD,
+		};
+
+		/** Coroutine suspended on the radio, at most one at a time **/
+		std::coroutine_handle<> _coro_waiter{};
+		volatile CoroOperation _coro_operation = CoroOperation::NONE;
+		bool _coro_result = false;
+		uint8_t _coro_rx_length = 0;
+		uint32_t _coro_deadline = 0;
+		/** RxDone has queued the FIFO drain for receive(); the deadline no longer applies **/
+		volatile bool _coro_rx_draining = false;
+		bool _coro_cad_detected = false;
+		/** CadDone flag read and clear, reserved when cad() starts **/
+		static constexpr uint8_t cad_done_slots = 2;
+
+		bool coro_start_transmit(std::coroutine_handle<> handle, etl::span<const uint8_t> data);
+		bool coro_start_receive(std::coroutine_handle<> handle, etl::span<uint8_t> buffer, uint32_t deadline);
+		bool coro_start_cad(std::coroutine_handle<> handle);
+		void coro_resume(bool result);
+
+		void _handle_caddone_irq();
+		void _coro_cad_flags_read(const SpiTransaction& transaction);
+		void _coro_cad_cleared(const SpiTransaction& transaction);
+#endif
+
 		//TODO: add other settings, figure how to store them separately for FSK and LORA
 
 		/** Internal methods **/
@@ -106,16 +419,44 @@ namespace radio::sx1278 {
 		template <typename RegValPtr, typename RegAddr>
 		void SPI_BurstWrite(RegAddr addr, RegValPtr* val, uint8_t length);
 
+		template <typename RegAddr>
+		void SPI_BurstWrite(RegAddr addr, etl::span<const etl::span<const uint8_t>> segments);
+
 		template<typename RegVal, typename RegAddr>
 		etl::optional<RegVal> SPI_read(RegAddr reg);
 
 		template <typename RegAddr, typename RegValPtr>
 		bool SPI_burstRead(RegAddr addr, RegValPtr* val, uint8_t length);
 
+		template <typename RegAddr>
+		void write_config(RegAddr addr, uint8_t value);
+
 		void clear_irq_flags(IrqFlags flags = IrqFlags::All);
 
+#ifdef SX1278_SPI_DMA
+		enum class DmaTransfer : uint8_t {
+			NONE,
+			FIFO_LOAD,
+			FIFO_DRAIN,
+		};
+
+		volatile DmaTransfer _dma_transfer = DmaTransfer::NONE;
+		uint8_t* _dma_data = nullptr;
+		uint8_t _dma_length = 0;
+		/** pool buffer a FIFO drain of getReceivedFrame() is landing in **/
+		FrameHandle _rx_pending_frame;
+
+		template <typename RegValPtr, typename RegAddr>
+		bool SPI_BurstWrite_DMA(RegAddr addr, RegValPtr* val, uint8_t length);
+
+		template <typename RegAddr, typename RegValPtr>
+		bool SPI_burstRead_DMA(RegAddr addr, RegValPtr* val, uint8_t length);
+#endif
+
 	};
 
 }
 
+#include "SX1278.tpp"
+
 #endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_HPP
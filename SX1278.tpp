@@ -0,0 +1,2275 @@
+/**
+* @author Jakub Bubak
+* @date 07.11.2023
+*/
+
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_TPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_TPP
+
+#include <cassert>
+
+#include "SX1278.hpp"
+
+
+/**
+ * @brief Writes a value to a register in the SX1278 LoRa transceiver via SPI.
+ *
+ * @tparam RegVal The data type of the register value.
+ * @tparam RegAddr The data type of the register address.
+ * @param addr The address of the register to write to.
+ * @param val The value to write to the register.
+ *
+ * @note This function assumes that the register address and value are both 1 byte long.
+ * @note The MSB of the address is set to 1 to indicate a write operation.
+ * @note Address and value are clocked out as a single 2-byte full-duplex transfer under one NSS assertion.
+ */
+template <typename Transport, typename Clock>
+template <typename RegVal, typename RegAddr>
+void radio::sx1278::SX1278<Transport, Clock>::SPI_write(RegAddr addr, RegVal val) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+	static_assert(sizeof(RegVal) == 1, "Register value must be 1 byte long");
+
+	uint8_t tx[2] = {
+			static_cast<uint8_t>(static_cast<uint8_t>(addr) | 0x80), /** set MSB to 1 to indicate write **/
+			static_cast<uint8_t>(val)
+	};
+	uint8_t rx[2];
+
+#ifdef SX1278_PROFILER
+	auto start = Clock::now();
+#endif
+	transport.select();
+	transport.transfer(tx, rx, sizeof(tx)); /** address and value in one transfer **/
+	transport.deselect();
+#ifdef SX1278_PROFILER
+	_profiler.record(tx[0], sizeof(tx), Clock::now() - start);
+#endif
+
+	//TODO: add error handling
+}
+
+/**
+ * @brief Writes a burst of values to consecutive registers in the SX1278 LoRa transceiver via SPI.
+ *
+ * @tparam RegValPtr The data type of the pointer to register values.
+ * @tparam RegAddr The data type of the register address.
+ * @param addr The starting address of the register to write to.
+ * @param val A pointer to the array of values to write to consecutive registers.
+ * @param length The number of values to write in the burst.
+ *
+ * @note This function assumes that the register address is 1 byte long, and the pointer to register values points to 1-byte values.
+ * @note The MSB of the address is set to 1 to indicate a write operation.
+ *
+ */
+template <typename Transport, typename Clock>
+template<typename RegValPtr, typename RegAddr>
+void radio::sx1278::SX1278<Transport, Clock>::SPI_BurstWrite(RegAddr addr, RegValPtr* val, uint8_t length) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+	static_assert(sizeof(RegValPtr) == 1, "Pointer to Register values must be 1 byte long");
+
+	uint8_t address = static_cast<uint8_t>(addr) | 0x80; /** set MSB to 1 to indicate write **/
+
+#ifdef SX1278_PROFILER
+	auto start = Clock::now();
+#endif
+	transport.select();
+
+	/** blocking transport calls return with the bus idle, so NSS stays low across both **/
+	transport.write(&address, sizeof(address)); /** send address **/
+	transport.write(val, length); /** send value **/
+
+	transport.deselect();
+#ifdef SX1278_PROFILER
+	_profiler.record(address, sizeof(address) + length, Clock::now() - start);
+#endif
+
+	//TODO: add error handling
+}
+
+/**
+ * @brief Writes several buffers back to back in one burst, under a single NSS assertion.
+ *
+ * @tparam RegAddr The data type of the register address.
+ * @param addr The starting address of the register to write to (RegFifo to stream into the FIFO).
+ * @param segments Buffers sent one after another, as if they were one contiguous array.
+ *
+ * @note The MSB of the address is set to 1 to indicate a write operation.
+ */
+template <typename Transport, typename Clock>
+template<typename RegAddr>
+void radio::sx1278::SX1278<Transport, Clock>::SPI_BurstWrite(RegAddr addr, etl::span<const etl::span<const uint8_t>> segments) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+
+	uint8_t address = static_cast<uint8_t>(addr) | 0x80; /** set MSB to 1 to indicate write **/
+
+#ifdef SX1278_PROFILER
+	auto start = Clock::now();
+	uint16_t bytes = sizeof(address);
+#endif
+	transport.select();
+
+	transport.write(&address, sizeof(address)); /** send address **/
+	for(const auto& segment : segments) {
+		if(segment.empty())
+			continue;
+		transport.write(segment.data(), static_cast<uint16_t>(segment.size())); /** send values **/
+#ifdef SX1278_PROFILER
+		bytes += segment.size();
+#endif
+	}
+
+	transport.deselect();
+#ifdef SX1278_PROFILER
+	_profiler.record(address, bytes, Clock::now() - start);
+#endif
+
+	//TODO: add error handling
+}
+
+/**
+ * @brief Reads a value from a register in the SX1278 LoRa transceiver via SPI.
+ *
+ * @tparam RegVal The data type of the register value.
+ * @tparam RegAddr The data type of the register address.
+ * @param reg The address of the register to read from.
+ *
+ * @note This function assumes that the register address and value are both 1 byte long.
+ * @note The MSB of the address is set to 0 to indicate a read operation.
+ * @note Address and dummy byte are clocked as a single 2-byte full-duplex transfer; the value arrives in the second byte.
+ *
+ * @return An optional containing the read value if the read operation was successful; otherwise, an empty optional.
+ */
+
+template <typename Transport, typename Clock>
+template <typename RegVal, typename RegAddr>
+etl::optional<RegVal> radio::sx1278::SX1278<Transport, Clock>::SPI_read(RegAddr reg) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+	static_assert(sizeof(RegVal) == 1, "Register value must be 1 byte long");
+
+	uint8_t tx[2] = {
+			static_cast<uint8_t>(static_cast<uint8_t>(reg) & 0x7F), /** set MSB to 0 to indicate read **/
+			0x00 /** dummy byte clocking out the register value **/
+	};
+	uint8_t rx[2];
+
+#ifdef SX1278_PROFILER
+	auto start = Clock::now();
+#endif
+	transport.select();
+	auto status = transport.transfer(tx, rx, sizeof(tx));
+	transport.deselect();
+#ifdef SX1278_PROFILER
+	_profiler.record(tx[0], sizeof(tx), Clock::now() - start);
+#endif
+
+	if(status) {
+		return static_cast<RegVal>(rx[1]);
+	}
+	return etl::nullopt;
+}
+
+/**
+ * @brief Reads a burst of values from consecutive registers (or the FIFO) in the SX1278 LoRa transceiver via SPI.
+ *
+ * @tparam RegAddr The data type of the register address.
+ * @tparam RegValPtr The data type of the pointer to register values.
+ * @param addr The starting address of the register to read from.
+ * @param val A pointer to the buffer receiving the values.
+ * @param length The number of values to read in the burst.
+ *
+ * @note The MSB of the address is set to 0 to indicate a read operation.
+ *
+ * @return True if the transfer succeeded.
+ */
+template <typename Transport, typename Clock>
+template <typename RegAddr, typename RegValPtr>
+bool radio::sx1278::SX1278<Transport, Clock>::SPI_burstRead(RegAddr addr, RegValPtr* val, uint8_t length) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+	static_assert(sizeof(RegValPtr) == 1, "Pointer to Register values must be 1 byte long");
+
+	uint8_t address = static_cast<uint8_t>(addr) & 0x7F; /** set MSB to 0 to indicate read **/
+
+#ifdef SX1278_PROFILER
+	auto start = Clock::now();
+#endif
+	transport.select();
+
+	/** blocking transport calls return with the bus idle, so NSS stays low across both **/
+	auto status = transport.write(&address, sizeof(address)); /** send address **/
+	if(status) {
+		status = transport.read(val, length);
+	}
+
+	transport.deselect();
+#ifdef SX1278_PROFILER
+	_profiler.record(address, sizeof(address) + length, Clock::now() - start);
+#endif
+
+	return status;
+}
+
+#ifdef SX1278_SPI_DMA
+/**
+ * @brief Starts a DMA burst write to consecutive registers (or the FIFO) in the SX1278 LoRa transceiver.
+ *
+ * @tparam RegValPtr The data type of the pointer to register values.
+ * @tparam RegAddr The data type of the register address.
+ * @param addr The starting address of the register to write to.
+ * @param val A pointer to the values to write; must stay valid until on_spi_dma_complete() runs.
+ * @param length The number of values to write in the burst.
+ *
+ * @note NSS is asserted and the address byte is sent blocking; the payload is handed to DMA and NSS
+ *       is released from on_spi_dma_complete().
+ * @note Cache maintenance of the buffer is left to the transport.
+ *
+ * @return True if the DMA transfer was started.
+ */
+template <typename Transport, typename Clock>
+template<typename RegValPtr, typename RegAddr>
+bool radio::sx1278::SX1278<Transport, Clock>::SPI_BurstWrite_DMA(RegAddr addr, RegValPtr* val, uint8_t length) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+	static_assert(sizeof(RegValPtr) == 1, "Pointer to Register values must be 1 byte long");
+
+	uint8_t address = static_cast<uint8_t>(addr) | 0x80; /** set MSB to 1 to indicate write **/
+
+	transport.select();
+
+	auto status = transport.write(&address, sizeof(address)); /** send address **/
+	if(status) {
+		status = transport.write_dma(val, length);
+	}
+
+	if(!status) {
+		transport.deselect();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Starts a DMA burst read from consecutive registers (or the FIFO) in the SX1278 LoRa transceiver.
+ *
+ * @tparam RegAddr The data type of the register address.
+ * @tparam RegValPtr The data type of the pointer to register values.
+ * @param addr The starting address of the register to read from.
+ * @param val A pointer to the buffer receiving the values; must stay valid until on_spi_dma_complete() runs.
+ * @param length The number of values to read in the burst.
+ *
+ * @note Cache maintenance of the buffer is left to the transport; see HalTransport for alignment requirements.
+ *
+ * @return True if the DMA transfer was started.
+ */
+template <typename Transport, typename Clock>
+template <typename RegAddr, typename RegValPtr>
+bool radio::sx1278::SX1278<Transport, Clock>::SPI_burstRead_DMA(RegAddr addr, RegValPtr* val, uint8_t length) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+	static_assert(sizeof(RegValPtr) == 1, "Pointer to Register values must be 1 byte long");
+
+	uint8_t address = static_cast<uint8_t>(addr) & 0x7F; /** set MSB to 0 to indicate read **/
+
+	transport.select();
+
+	auto status = transport.write(&address, sizeof(address)); /** send address **/
+	if(status) {
+		status = transport.read_dma(val, length);
+	}
+
+	if(!status) {
+		transport.deselect();
+		return false;
+	}
+	return true;
+}
+#endif
+
+/**
+ * @brief Resets the SX1278 LoRa transceiver.
+ *
+ * This function performs a reset operation on the SX1278 LoRa transceiver by toggling the reset pin.
+ *
+ * @note The reset pulse itself (pull low, short wait, release, wait for the chip) is generated by the transport.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::reset() {
+	transport.reset();
+	drop_fifo_contents();
+
+	/** the chip is back to one FIFO region at 0x00 **/
+	_fifo_slot_count = 0;
+	_fifo_slot_size = 0;
+	_fifo_rx_base = 0;
+	_fifo_tx_base = 0;
+}
+
+
+/**
+ * @brief Transmits data using the SX1278 LoRa transceiver.
+ *
+ * This function prepares and requests data transmission using the SX1278 LoRa transceiver.
+ *
+ * @param data A pointer to the data to be transmitted.
+ * @param length The length of the data to be transmitted.
+ *
+ * @note The function sets the transceiver to STDBY mode, configures the FIFO address and payload length registers,
+ *       writes the data to be transmitted to the FIFO, and then sets the transceiver to TX mode for transmission.
+ * @note With SX1278_SPI_DMA the FIFO load runs on DMA and TX mode is entered from on_spi_dma_complete();
+ *       data must stay valid until then.
+ *
+ * @return Clock time at which TxDone is expected: TX start-up plus the time on air with the current settings.
+ *         With SX1278_SPI_DMA this is only an estimate made before TX is entered: it leaves out the DMA transfer and
+ *         assumes a cold start; get_tx_done_time() has the exact value once on_spi_dma_complete() has run.
+ */
+//TODO: change name
+template <typename Transport, typename Clock>
+uint32_t radio::sx1278::SX1278<Transport, Clock>::startTransmit(const uint8_t* data, uint8_t length) {
+	_tx_request_ticks = Clock::now();
+	set_mode(lora::Mode::STDBY);
+	load_and_transmit(data, length);
+
+#ifdef SX1278_SPI_DMA
+	if(is_dma_busy()) // TX is only entered once the FIFO load completes
+		return Clock::now() + us_to_ticks<Clock>(pll_lock_us + pa_ramp_us + get_time_on_air_us(length));
+#endif
+	return _tx_done_ticks;
+}
+
+/**
+ * @brief Transmits a frame gathered from several buffers, e.g. a protocol header and an application payload.
+ *
+ * The segments are streamed into RegFifo one after another in a single burst, so they never have to be copied into
+ * one contiguous buffer.
+ *
+ * @param segments Buffers making up the frame, in order; empty segments are skipped.
+ *
+ * @return Expected TxDone Clock time as for startTransmit(), or nullopt if the frame is longer than 255 bytes
+ *         (nothing is sent then).
+ *
+ * @note The FIFO load is always blocking, also with SX1278_SPI_DMA.
+ */
+template <typename Transport, typename Clock>
+etl::optional<uint32_t> radio::sx1278::SX1278<Transport, Clock>::startTransmit(etl::span<const etl::span<const uint8_t>> segments) {
+	std::size_t length = 0;
+	for(const auto& segment : segments) {
+		length += segment.size();
+	}
+	if(length > 0xFF)
+		return etl::nullopt;
+
+	_tx_request_ticks = Clock::now();
+	set_mode(lora::Mode::STDBY);
+	prepare_tx_fifo(static_cast<uint8_t>(length));
+	SPI_BurstWrite(RegisterAddress::RegFifo, segments);
+
+	_fifo_tx_valid = true;
+	set_mode(lora::Mode::TX);
+	return _tx_done_ticks;
+}
+
+/**
+ * @brief Claims the on-the-fly TX area (the RX region) for a frame of the given length.
+ *
+ * Staged slots the frame wraps into are dropped. Shared by the blocking and the queued FIFO loads.
+ *
+ * @return True if RegFifoTxBaseAddr still points at a staged slot and has to be moved back to the RX region.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::claim_tx_area(uint8_t length) {
+	if(_fifo_slot_count != 0 && length > 0x100 - _fifo_rx_base) {
+		for(auto& slot_length : _fifo_slot_length) {
+			slot_length = 0; /** the frame wraps around the FIFO into the staged slots **/
+		}
+	}
+
+	if(_fifo_tx_base == _fifo_rx_base)
+		return false;
+	_fifo_tx_base = _fifo_rx_base;
+	return true;
+}
+
+/**
+ * @brief Points the FIFO at the on-the-fly TX area and sets the payload length, ready for the FIFO load.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::prepare_tx_fifo(uint8_t length) {
+	_tx_length = length;
+	if(!claim_tx_area(length)) {
+		SPI_write(lora::RegisterAddress::RegFifoAddrPtr, _fifo_rx_base);
+	} else {
+		/** back from a staged slot: RegFifoAddrPtr and RegFifoTxBaseAddr are adjacent, set both in one burst **/
+		uint8_t pointers[2] = {_fifo_rx_base, _fifo_rx_base};
+		SPI_BurstWrite(lora::RegisterAddress::RegFifoAddrPtr, pointers, sizeof(pointers));
+	}
+	SPI_write(lora::RegisterAddress::RegPayloadLength, length);
+}
+
+/**
+ * @brief Loads a frame into the FIFO and enters TX; the transceiver has to be in STDBY (or SLEEP) already.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::load_and_transmit(const uint8_t* data, uint8_t length) {
+	prepare_tx_fifo(length);
+	_fifo_tx_valid = true;
+
+#ifdef SX1278_SPI_DMA
+	_dma_transfer = DmaTransfer::FIFO_LOAD;
+	if(SPI_BurstWrite_DMA(RegisterAddress::RegFifo, data, length))
+		return;
+	_dma_transfer = DmaTransfer::NONE; // DMA start refused, fall back to the blocking burst below
+#endif
+	SPI_BurstWrite(RegisterAddress::RegFifo, data, length);
+
+	set_mode(lora::Mode::TX);
+}
+
+/**
+ * @brief Transmits the payload still held in the FIFO again, without uploading it over SPI.
+ *
+ * Only the FIFO pointer and the mode are written; RegPayloadLength keeps the length of the last transmission.
+ * The FIFO copy is tracked in software (dropped on SLEEP, reset and received packets), and RegIrqFlags .. RegModemStat
+ * are read in one burst to catch a packet written over it since the last TxDone: RxDone / ValidHeader for finished
+ * and explicit-header packets, the ModemStat signal detected / synchronized / RX on-going / header valid bits for a
+ * reception still in progress, which is the only trace an implicit-header packet leaves before RxDone.
+ *
+ * @return True if TX was entered, false if the FIFO no longer holds the payload (use startTransmit()), a frame is
+ *         on air or prelocked in FSTX, or the TX queue is draining.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::retransmit() {
+	if(!_fifo_tx_valid || _tx_active || _current_mode == lora::Mode::TX || _current_mode == lora::Mode::FSTX)
+		return false;
+
+	/** RegIrqFlags .. RegModemStat **/
+	uint8_t status[7];
+	if(!SPI_burstRead(lora::RegisterAddress::RegIrqFlags, status, sizeof(status)))
+		return false;
+
+	uint8_t irq_flags = status[0];
+	uint8_t modem_status = status[6];
+	if((irq_flags & (IrqFlags::RxDone | IrqFlags::ValidHeader)) || (modem_status & 0x0F)) {
+		_fifo_tx_valid = false; // RX wrote (or is writing) into the FIFO, flags are cleared on TxDone so this is after our TX
+		return false;
+	}
+
+	_tx_request_ticks = Clock::now();
+	set_mode(lora::Mode::STDBY);
+	SPI_write(lora::RegisterAddress::RegFifoAddrPtr, _fifo_tx_base);
+	set_mode(lora::Mode::TX);
+	return true;
+}
+
+/**
+ * @brief Loads a frame and parks the transceiver in FSTX with the PLL locked, ready for transmit_prelocked().
+ *
+ * The FIFO is filled in STDBY, then FSTX is entered and DIO0 is mapped to TxDone, so the later FSTX->TX switch is a
+ * single OpMode write and the preamble starts after the PA ramp only, without the PLL lock time.
+ *
+ * @return False if a transmission is on air.
+ *
+ * @note The transceiver stays in FSTX (and does not receive) until transmit_prelocked() or another mode change.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::prelock_transmit(const uint8_t* data, uint8_t length) {
+	if(_tx_active || _current_mode == lora::Mode::TX)
+		return false;
+
+	if(_current_mode != lora::Mode::STDBY)
+		set_mode(lora::Mode::STDBY);
+
+	prepare_tx_fifo(length);
+	SPI_BurstWrite(RegisterAddress::RegFifo, data, length);
+	_fifo_tx_valid = true;
+
+	set_mode(lora::Mode::FSTX);
+	return true;
+}
+
+/**
+ * @brief Starts the frame loaded by prelock_transmit(), going FSTX->TX directly.
+ *
+ * @return False if the transceiver is not in FSTX any more.
+ *
+ * @note The start latency is available from get_tx_start_latency() right after the call.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::transmit_prelocked() {
+	if(_current_mode != lora::Mode::FSTX)
+		return false;
+
+	_tx_request_ticks = Clock::now();
+	set_mode(lora::Mode::TX);
+	return true;
+}
+
+/**
+ * @brief Returns the time on air of a frame of the given length with the current modem settings.
+ *
+ * @param length Payload length in bytes.
+ *
+ * @return Time on air in microseconds, see lora::time_on_air_us(); LowDataRateOptimize is taken from the register shadow.
+ */
+template <typename Transport, typename Clock>
+uint32_t radio::sx1278::SX1278<Transport, Clock>::get_time_on_air_us(uint8_t length) const {
+	return lora::time_on_air_us(length, _spreading_factor, _bandwidth, _coding_rate, _header_mode, _crc, _preamble_length,
+	                            low_data_rate());
+}
+
+/**
+ * @brief Returns the symbol time 2^SF / BW with the current modem settings, in microseconds.
+ */
+template <typename Transport, typename Clock>
+uint32_t radio::sx1278::SX1278<Transport, Clock>::get_symbol_time_us() const {
+	return lora::symbol_time_us(_spreading_factor, _bandwidth);
+}
+
+/**
+ * @brief Stamps a DIO0 event; the end of the preamble is done minus the header and payload symbols of a
+ *        length-byte frame with the current modem settings.
+ *
+ * @note The modem's own RxDone / TxDone delay (a few microseconds) is not taken out.
+ */
+template <typename Transport, typename Clock>
+radio::sx1278::EventTime radio::sx1278::SX1278<Transport, Clock>::event_time(uint32_t done, uint8_t length) const {
+	uint32_t symbols = lora::payload_symbols(length, _spreading_factor, _coding_rate, _header_mode, _crc, low_data_rate());
+	return {done, done - us_to_ticks<Clock>(symbols * get_symbol_time_us())};
+}
+
+/**
+ * @brief Forgets everything the driver knows about the FIFO contents (last TX payload, staged frames).
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::drop_fifo_contents() {
+	_fifo_tx_valid = false;
+	for(auto& slot_length : _fifo_slot_length) {
+		slot_length = 0;
+	}
+}
+
+/**
+ * @brief Splits the FIFO into staged TX slots and an RX region.
+ *
+ * Slots are laid out from address 0x00, each size bytes long; RegFifoRxBaseAddr is placed right after them. Frames
+ * sent with startTransmit() / queueTransmit() are loaded into the RX region as well, so they never touch the slots.
+ * RegMaxPayloadLength is limited to the RX region, longer packets are dropped by the modem instead of wrapping
+ * around into the slots (in implicit header mode RegPayloadLength has to fit as well).
+ *
+ * @param count Number of TX slots, 0 gives the whole FIFO back to RX and on-the-fly frames.
+ * @param size Size of each slot in bytes.
+ *
+ * @return False if the layout does not fit (at most fifo_max_slots slots, at least 1 byte left for RX).
+ *
+ * @note All staged frames are dropped.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::set_fifo_slots(uint8_t count, uint8_t size) {
+	if(count > fifo_max_slots || count * size > 0xFF)
+		return false;
+
+	drop_fifo_contents();
+	_fifo_slot_count = count;
+	_fifo_slot_size = size;
+
+	_fifo_rx_base = count * size;
+	_fifo_tx_base = _fifo_rx_base;
+
+	uint8_t bases[2] = {_fifo_tx_base, _fifo_rx_base}; /** RegFifoTxBaseAddr, RegFifoRxBaseAddr **/
+	SPI_BurstWrite(lora::RegisterAddress::RegFifoTxBaseAddr, bases, sizeof(bases));
+
+	uint8_t max_payload = (_fifo_rx_base == 0) ? 0xFF : static_cast<uint8_t>(0x100 - _fifo_rx_base);
+	SPI_write(lora::RegisterAddress::RegMaxPayloadLength, max_payload);
+	return true;
+}
+
+/**
+ * @brief Loads a frame into a TX slot, to be sent later with transmit_staged().
+ *
+ * The FIFO can only be filled in STDBY, so a running RXCONTINUOUS is paused for the upload and restarted after it;
+ * from any other mode the transceiver is left in STDBY.
+ *
+ * @return False if the slot does not exist, the frame does not fit in it, or a transmission is on air.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::stage_frame(uint8_t slot, const uint8_t* data, uint8_t length) {
+	if(slot >= _fifo_slot_count || length == 0 || length > _fifo_slot_size)
+		return false;
+	if(_tx_active || _current_mode == lora::Mode::TX)
+		return false;
+
+	write_fifo_standby(slot * _fifo_slot_size, data, length);
+	_fifo_slot_length[slot] = length;
+	return true;
+}
+
+/**
+ * @brief Rewrites part of a staged frame in place, e.g. a counter or a timestamp of a periodic frame.
+ *
+ * RegFifoAddrPtr is pointed at the offset inside the slot and only the new bytes are sent, the rest of the frame
+ * stays resident; transmit_staged() then sends the updated frame. Like stage_frame(), a running RXCONTINUOUS is
+ * paused for the write.
+ *
+ * @param slot Slot holding the frame.
+ * @param offset Offset of the first byte to replace, from the start of the frame.
+ * @param data New bytes.
+ * @param length Number of bytes to replace; the patch cannot extend the frame.
+ *
+ * @return False if the slot is empty, the patch reaches past the end of the frame, or a transmission is on air.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::patch_frame(uint8_t slot, uint8_t offset, const uint8_t* data, uint8_t length) {
+	if(slot >= _fifo_slot_count || length == 0 || offset + length > _fifo_slot_length[slot])
+		return false;
+	if(_tx_active || _current_mode == lora::Mode::TX)
+		return false;
+
+	write_fifo_standby(slot * _fifo_slot_size + offset, data, length);
+	return true;
+}
+
+/**
+ * @brief Writes data to the FIFO at the given address, switching to STDBY for it and restarting RXCONTINUOUS after.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::write_fifo_standby(uint8_t address, const uint8_t* data, uint8_t length) {
+	lora::Mode previous = _current_mode;
+	if(previous != lora::Mode::STDBY)
+		set_mode(lora::Mode::STDBY);
+
+	SPI_write(lora::RegisterAddress::RegFifoAddrPtr, address);
+	SPI_BurstWrite(RegisterAddress::RegFifo, data, length);
+
+	if(previous == lora::Mode::RXCONTINUOUS)
+		set_mode(lora::Mode::RXCONTINUOUS);
+}
+
+/**
+ * @brief Transmits a frame staged with stage_frame().
+ *
+ * Only RegFifoTxBaseAddr, RegPayloadLength and the mode are written, the payload is already in the FIFO.
+ * The slot keeps its frame and can be transmitted again; retransmit() repeats it as well.
+ *
+ * @return False if the slot is empty or a transmission is on air.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::transmit_staged(uint8_t slot) {
+	if(slot >= _fifo_slot_count || _fifo_slot_length[slot] == 0)
+		return false;
+	if(_tx_active || _current_mode == lora::Mode::TX)
+		return false;
+
+	_tx_request_ticks = Clock::now();
+	if(_current_mode != lora::Mode::STDBY)
+		set_mode(lora::Mode::STDBY);
+
+	_fifo_tx_base = slot * _fifo_slot_size;
+	SPI_write(lora::RegisterAddress::RegFifoTxBaseAddr, _fifo_tx_base);
+	SPI_write(lora::RegisterAddress::RegPayloadLength, _fifo_slot_length[slot]);
+	_tx_length = _fifo_slot_length[slot];
+
+	_fifo_tx_valid = true;
+	set_mode(lora::Mode::TX);
+	return true;
+}
+
+/**
+ * @brief Returns true while the FIFO is known to still hold the last transmitted payload.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::is_fifo_tx_valid() const {
+	return _fifo_tx_valid;
+}
+
+/**
+ * @brief Queues a frame for back-to-back transmission.
+ *
+ * If nothing is on air the frame is transmitted right away, otherwise it is appended to the TX queue. On TxDone the
+ * next queued frame is loaded and transmitted straight from the interrupt (the chip is already in STDBY after TxDone),
+ * the transceiver only goes back to RXCONTINUOUS once the queue is empty.
+ *
+ * @param data A pointer to the data to be transmitted; must stay valid until its TxDone.
+ * @param length The length of the data to be transmitted.
+ *
+ * @return True if the frame was started or queued, false if the TX queue is full.
+ *
+ * @note Do not mix with startTransmit() / startTransmitAsync() while the queue is draining.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::queueTransmit(const uint8_t* data, uint8_t length) {
+	FrameHandle none;
+	return enqueue_transmit(data, length, none);
+}
+
+/**
+ * @brief Queues a pool frame for back-to-back transmission, see queueTransmit(const uint8_t*, uint8_t).
+ *
+ * The driver takes the handle over and releases the buffer on the frame's TxDone, so the payload goes from the
+ * pool buffer to the FIFO without another copy.
+ *
+ * @param frame Frame to send, frame->length bytes.
+ *
+ * @return True if the frame was started or queued; false if the handle is empty or the TX queue is full, the caller
+ *         then still owns the frame.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::queueTransmit(FrameHandle&& frame) {
+	if(!frame)
+		return false;
+	return enqueue_transmit(frame->data, frame->length, frame);
+}
+
+/** Starts the frame or appends it to the TX queue; frame is moved from only on success **/
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::enqueue_transmit(const uint8_t* data, uint8_t length, FrameHandle& frame) {
+	uint32_t state = transport.critical_enter();
+	if(_tx_active) {
+		if(_tx_count == tx_queue_depth) {
+			transport.critical_exit(state);
+			return false;
+		}
+		TxFrame& entry = _tx_queue[(_tx_head + _tx_count) % tx_queue_depth];
+		entry.data = data;
+		entry.length = length;
+		entry.frame = std::move(frame);
+		_tx_count = _tx_count + 1;
+		transport.critical_exit(state);
+		return true;
+	}
+	_tx_active = true;
+	_tx_on_air = std::move(frame);
+	transport.critical_exit(state);
+
+	_tx_request_ticks = Clock::now();
+	set_mode(lora::Mode::STDBY);
+	load_and_transmit(data, length);
+	return true;
+}
+
+/**
+ * @brief Returns the number of frames waiting in the TX queue, not counting the one on air.
+ */
+template <typename Transport, typename Clock>
+uint8_t radio::sx1278::SX1278<Transport, Clock>::tx_queue_size() const {
+	return _tx_count;
+}
+
+/**
+ * @brief Receives data using the SX1278 LoRa transceiver.
+ *
+ * This function receives data using the SX1278 LoRa transceiver and stores it in the provided buffer.
+ *
+ * @param data A pointer to the buffer where received data will be stored.
+ * @param length The maximum length of data to be received and stored in the buffer.
+ *
+ * @return The actual number of bytes received and stored in the buffer.
+ *
+ * @note The function sets the transceiver to STDBY mode and checks for the RxDone interrupt flag.
+ * @note If the RxDone flag is set, the function clears the interrupt flags, reads the number of received bytes,
+ *       and reads the received data into the provided buffer.
+ * @note The function sets the transceiver back to RXCONTINUOUS mode and returns the number of bytes received.
+ */
+
+// TODO: check IRQ mask
+// TODO: PA ramp up time set
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::startReceive() {
+	set_mode(lora::Mode::RXCONTINUOUS);
+}
+
+// Should only be called after RxDone
+// With SX1278_SPI_DMA the data is only valid once on_rx_data fires
+template <typename Transport, typename Clock>
+uint8_t radio::sx1278::SX1278<Transport, Clock>::getReceivedData(uint8_t* data, uint8_t length) {
+	// TODO: packet crc check
+	// TODO: header crc check
+	/** RegFiFoRxCurrentAddr .. RegPktRssiValue are adjacent: IRQ flags, length, FIFO address, SNR and RSSI in one burst **/
+	uint8_t status[rx_status_length];
+	if (!SPI_burstRead(lora::RegisterAddress::RegFiFoRxCurrentAddr, status, sizeof(status)))
+		return 0; // TODO: error handling
+
+	decode_rx_status(status);
+	auto irq_flags = static_cast<IrqFlags>(_rx_irq_flags);
+	_rx_time = event_time(_dio0_ticks, (this->_header_mode == lora::HeaderMode::EXPLICIT) ? status[3] : length);
+
+	if (!(irq_flags & IrqFlags::RxDone))
+		return 0; // TODO: error handling
+
+	_fifo_tx_valid = false; // the packet was written over the last TX payload
+
+	// TODO: notify about CRC error
+
+	if (this->_header_mode == lora::HeaderMode::IMPLICIT && length == 0)
+		return 0; // TODO: error handling, unknown length
+		
+	if (this->_header_mode == lora::HeaderMode::EXPLICIT) {
+		length = status[3];
+	}
+
+	SPI_write(lora::RegisterAddress::RegFifoAddrPtr, status[0]);
+
+#ifdef SX1278_SPI_DMA
+	_dma_data = data;
+	_dma_length = length;
+	_dma_transfer = DmaTransfer::FIFO_DRAIN;
+	if(SPI_burstRead_DMA(RegisterAddress::RegFifo, data, length))
+		return length; // IRQ flags are cleared from on_spi_dma_complete()
+	_dma_transfer = DmaTransfer::NONE; // DMA start refused, fall back to the blocking burst below
+#endif
+	SPI_burstRead(RegisterAddress::RegFifo, data, length);
+
+	// for(int i = 0; i < length; i++) {
+	// 	data[i] = SPI_read<uint8_t>(RegisterAddress::RegFifo).value();
+	// }
+	
+	clear_irq_flags();
+
+	return length;
+}
+
+/**
+ * @brief Receives a frame straight into a pool buffer, see getReceivedData().
+ *
+ * @param pool Pool the buffer is taken from.
+ * @param length The number of bytes to read in implicit header mode, ignored in explicit header mode.
+ *
+ * @return Handle to the frame, with FrameBuffer::length set; empty if no packet was waiting or the pool is exhausted
+ *         (the packet stays in the FIFO then).
+ *
+ * @note With SX1278_SPI_DMA the handle is kept while the FIFO drain runs and an empty one is returned; the frame is
+ *       handed to on_rx_frame, length set, once the drain has completed.
+ */
+template <typename Transport, typename Clock>
+radio::sx1278::FrameHandle radio::sx1278::SX1278<Transport, Clock>::getReceivedFrame(FramePoolBase& pool, uint8_t length) {
+	FrameHandle frame = pool.allocate();
+	if(!frame)
+		return frame;
+
+	length = getReceivedData(frame->data, length);
+	if(length == 0) {
+		frame.release();
+		return frame;
+	}
+
+#ifdef SX1278_SPI_DMA
+	if(is_dma_busy()) {
+		_rx_pending_frame = std::move(frame); // delivered from on_spi_dma_complete()
+		return {};
+	}
+#endif
+	frame->length = length;
+	return frame;
+}
+
+/**
+ * @brief Sets the frequency of the SX1278 LoRa transceiver.
+ *
+ * This function sets the operating frequency of the SX1278 LoRa transceiver by configuring its registers
+ * based on the given frequency value.
+ *
+ * @param frequency The desired frequency in MegaHertz (MHz) to be set.
+ *
+ * @note This function uses a formula from the datasheet to calculate the register values needed to set the frequency.
+ * @note The calculated values are written to the appropriate registers (RegFrMsb, RegFrMid, and RegFrLsb)
+ *       in a single burst.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_frequency(uint32_t frequency) {
+	uint32_t F = (frequency * 524288) >> 5;
+
+	RegisterBatch batch;
+	RegisterBatch& target = (_batch != nullptr) ? *_batch : batch;
+
+	target.write(RegisterAddress::RegFrMsb, static_cast<uint8_t>((F >> 16) & 0xFF));
+	target.write(RegisterAddress::RegFrMid, static_cast<uint8_t>((F >> 8) & 0xFF));
+	target.write(RegisterAddress::RegFrLsb, static_cast<uint8_t>(F & 0xFF));
+
+	if(&target == &batch) {
+		commit(batch);
+	}
+
+	this->_frequency = frequency;
+}
+
+/**
+ * @brief Sets the spreading factor for LoRa modulation in the SX1278 LoRa transceiver.
+ *
+ * This function sets the spreading factor for LoRa modulation in the SX1278 LoRa transceiver
+ * by configuring the appropriate registers.
+ *
+ * @param spreading_factor The desired spreading factor to be set.
+ *
+ * @note The spreading factor bits are updated in the ModemConfig2 shadow, which is then written to the chip.
+ * @note The DetectOptimize field is updated the same way, without reading the register back.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_spreading_factor(radio::sx1278::lora::SpreadingFactor spreading_factor) {
+	_shadow.modem_config2 &= 0x0F; /** clear SF bits **/
+	_shadow.modem_config2 |= static_cast<uint8_t>(spreading_factor) << 4; /** set SF bits **/
+	write_config(lora::RegisterAddress::RegModemConfig2, _shadow.modem_config2);
+
+	// SF6 required optimization
+	if (spreading_factor == lora::SpreadingFactor::SF_6) {
+		set_header_mode(lora::HeaderMode::IMPLICIT);
+		write_config(lora::RegisterAddress::RegDetectionThreshold, static_cast<uint8_t>(0x0C));
+
+		// Set DetectionOptimize field to 0x05
+		_shadow.detect_optimize &= ~0b111;
+		_shadow.detect_optimize |= 0x05;
+		write_config(lora::RegisterAddress::RegDetectOptimize, _shadow.detect_optimize);
+	} else {
+		write_config(lora::RegisterAddress::RegDetectionThreshold, static_cast<uint8_t>(0x0A));
+
+		// Set DetectionOptimize field to 0x03
+		_shadow.detect_optimize &= ~0b111;
+		_shadow.detect_optimize |= 0x03;
+		write_config(lora::RegisterAddress::RegDetectOptimize, _shadow.detect_optimize);
+	}
+
+	this->_spreading_factor = spreading_factor;
+	update_low_data_rate_optimize();
+}
+
+/**
+ * @brief Sets the bandwidth for LoRa modulation in the SX1278 LoRa transceiver.
+ *
+ * This function sets the bandwidth for LoRa modulation in the SX1278 LoRa transceiver
+ * by configuring the appropriate registers.
+ *
+ * @param bandwidth The desired bandwidth to be set.
+ *
+ * @note The bandwidth bits are updated in the ModemConfig1 shadow, which is then written to the chip.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_bandwidth(radio::sx1278::lora::Bandwidth bandwidth) {
+	_shadow.modem_config1 &= 0x0F; /** clear BW bits **/
+	_shadow.modem_config1 |= static_cast<uint8_t>(bandwidth) << 4; /** set BW bits **/
+	write_config(lora::RegisterAddress::RegModemConfig1, _shadow.modem_config1);
+
+	this->_bandwidth = bandwidth;
+	update_low_data_rate_optimize();
+}
+
+/**
+ * @brief Enables LowDataRateOptimize in ModemConfig3 when the symbol time exceeds 16 ms, as the datasheet requires.
+ *
+ * @note Called by set_spreading_factor() and set_bandwidth(), so every SF / BW change keeps the bit consistent;
+ *       the register is only written when the bit changes.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::update_low_data_rate_optimize() {
+	/** symbol time = 2^SF / BW > 16 ms **/
+	uint8_t modem_config3 = _shadow.modem_config3 & 0xF7;
+	if(lora::low_data_rate_optimize(_spreading_factor, _bandwidth)) {
+		modem_config3 |= 0x08;
+	}
+
+	if(modem_config3 != _shadow.modem_config3) {
+		_shadow.modem_config3 = modem_config3;
+		write_config(lora::RegisterAddress::RegModemConfig3, _shadow.modem_config3);
+	}
+}
+
+/**
+ * @brief Sets the operating mode of the SX1278 LoRa transceiver.
+ *
+ * This function sets the operating mode of the SX1278 LoRa transceiver by configuring the appropriate registers.
+ *
+ * @param mode The desired operating mode to be set.
+ *
+ * @note The mode bits are updated in the OpMode shadow, so no read is needed on a TX/RX transition.
+ * @note Depending on the mode, the DIO0 mapping is also adjusted to handle TxDone or RxDone interrupts;
+ *       it is only written when the mapping actually changes.
+ * @note The updated value is then written back to the OpMode register, and the current mode is updated accordingly.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_mode(radio::sx1278::lora::Mode mode) {
+	uint8_t dio_mapping = _shadow.dio_mapping1;
+	if(mode == lora::Mode::TX || mode == lora::Mode::FSTX) {
+		dio_mapping = 0x40; /** set DIO0 to TxDone, already in FSTX so FSTX->TX is a single OpMode write **/
+	} else if(mode == lora::Mode::RXCONTINUOUS) {
+		dio_mapping = 0x00; /** set DIO0 to RxDone **/
+	} else if(mode == lora::Mode::CAD) {
+		dio_mapping = 0x80; /** set DIO0 to CadDone **/
+	}
+
+	if(dio_mapping != _shadow.dio_mapping1) {
+		_shadow.dio_mapping1 = dio_mapping;
+		SPI_write(RegisterAddress::RegDioMapping1, _shadow.dio_mapping1);
+	}
+
+	if(mode == lora::Mode::SLEEP) {
+		drop_fifo_contents(); /** FIFO is not kept in SLEEP **/
+	}
+
+	_shadow.op_mode &= 0xF8; /** clear mode bits **/
+	_shadow.op_mode |= static_cast<uint8_t>(mode); /** set mode bits **/
+	SPI_write(RegisterAddress::RegOpMode, _shadow.op_mode);
+
+	if(mode == lora::Mode::TX) {
+		tx_started(this->_current_mode == lora::Mode::FSTX);
+	}
+
+	this->_current_mode = mode;
+}
+
+/**
+ * @brief Records the start-up latency and the expected TxDone time once the TX OpMode write is on the bus.
+ *
+ * @param prelocked True if the transceiver was already in FSTX, the PLL lock is then skipped.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::tx_started(bool prelocked) {
+	_tx_latency.command_ticks = Clock::now() - _tx_request_ticks;
+	_tx_latency.prelocked = prelocked;
+	_tx_latency.startup_us = prelocked ? pa_ramp_us : pll_lock_us + pa_ramp_us;
+	_tx_done_ticks = Clock::now() + us_to_ticks<Clock>(_tx_latency.startup_us + get_time_on_air_us(_tx_length));
+}
+
+/**
+ * @brief Sets the payload CRC configuration for LoRa modulation.
+ *
+ * This function configures the payload CRC for LoRa modulation in the SX1278 LoRa transceiver
+ * by updating the ModemConfig2 register.
+ *
+ * @param crc The desired CRC configuration (ON or OFF).
+ *
+ * @note The CRC bit is updated in the ModemConfig2 shadow, which is then written to the chip.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_payload_crc(lora::PayloadCRC crc) {
+	if(crc == lora::PayloadCRC::ON) {
+		_shadow.modem_config2 |= 0x04;
+	} else {
+		_shadow.modem_config2 &= 0xFB;
+	}
+	write_config(lora::RegisterAddress::RegModemConfig2, _shadow.modem_config2);
+
+	this->_crc = crc;
+}
+
+/**
+ * @brief Sets the Over-Current Protection (OCP) for the SX1278 LoRa transceiver.
+ *
+ * This function configures the Over-Current Protection (OCP) for the SX1278 LoRa transceiver
+ * by calculating the appropriate value based on the maximum current provided and writing it to the OCP register.
+ *
+ * @param max_current The maximum current limit to set for OCP in milliamperes (mA), within the range of 45 mA to 240 mA.
+ *
+ * @note If the provided max_current value is outside the valid range, it is adjusted to the nearest valid value.
+ * @note The OCP trim value is calculated based on the datasheet formula and written to the OCP register.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_ocp(uint8_t max_current) {
+	uint8_t ocp_trim;
+
+	/** making sure that max current is in range **/
+	if(max_current > 240) {
+		max_current = 240;
+	} else if(max_current < 45) {
+		max_current = 45;
+	}
+
+	/** calculate ocp trim based on formula from datasheet**/
+	if(max_current <= 120) {
+		ocp_trim = (max_current - 45) / 5;
+	} else {
+		ocp_trim = (max_current + 30) / 10;
+	}
+
+	write_config(RegisterAddress::RegOcp, ocp_trim);
+
+	this->_max_current = max_current;
+}
+
+/**
+ * @brief Sets the transmit power level for the SX1278 LoRa transceiver.
+ *
+ * This function sets the transmit power level for the SX1278 LoRa transceiver by configuring the PaConfig register.
+ *
+ * @param power The desired transmit power level to be set.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_power(lora::Power power) {
+	_shadow.pa_config = static_cast<uint8_t>(power);
+	write_config(RegisterAddress::RegPaConfig, _shadow.pa_config);
+
+	this->_power = power;
+}
+
+/**
+ * @brief Sets the preamble length for LoRa communication in the SX1278 LoRa transceiver.
+ *
+ * This function sets the preamble length for LoRa communication in the SX1278 LoRa transceiver
+ * by configuring the PreambleMsb and PreambleLsb registers.
+ *
+ * @param preamble_length The desired preamble length in number of symbols.
+ *
+ * @note The preamble length is specified as a 16-bit value and is divided into MSB and LSB parts.
+ * @note The function sets the preamble length registers based on the provided preamble_length parameter,
+ *       both in a single burst.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_preamble_length(uint16_t preamble_length) {
+	assert(preamble_length >= 6); // TODO: better error handling
+
+	RegisterBatch batch;
+	RegisterBatch& target = (_batch != nullptr) ? *_batch : batch;
+
+	target.write(lora::RegisterAddress::RegPreambleMsb, static_cast<uint8_t>((preamble_length >> 8) & 0xFF));
+	target.write(lora::RegisterAddress::RegPreambleLsb, static_cast<uint8_t>(preamble_length & 0xFF));
+
+	if(&target == &batch) {
+		commit(batch);
+	}
+
+	this->_preamble_length = preamble_length;
+}
+
+/**
+ * @brief Sets the coding rate for LoRa communication in the SX1278 LoRa transceiver.
+ *
+ * This function sets the coding rate for LoRa communication in the SX1278 LoRa transceiver
+ * by configuring the ModemConfig1 register.
+ *
+ * @param coding_rate The desired coding rate to be set.
+ *
+ * @note The coding rate bits are updated in the ModemConfig1 shadow, which is then written to the chip.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_coding_rate(radio::sx1278::lora::CodingRate coding_rate) {
+	_shadow.modem_config1 &= 0xF1; /** clear CR bits **/
+	_shadow.modem_config1 |= static_cast<uint8_t>(coding_rate) << 1; /** set CR bits **/
+	write_config(lora::RegisterAddress::RegModemConfig1, _shadow.modem_config1);
+
+	this->_coding_rate = coding_rate;
+}
+
+/**
+ * @brief Sets the timeout value for LoRa communication in the SX1278 LoRa transceiver.
+ *
+ * This function sets the timeout value for LoRa communication in the SX1278 LoRa transceiver
+ * by configuring the SymbTimeoutLsb and ModemConfig2 registers.
+ *
+ * @param timeout The desired timeout value in symbols.
+ *
+ * @note The lower byte of the timeout value is written to the SymbTimeoutLsb register.
+ * @note The upper 2 bits of the timeout value are written to the ModemConfig2 register.
+ * @note The timeout value is specified in symbols.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_timeout(uint16_t timeout) {
+	write_config(lora::RegisterAddress::RegSymbTimeoutLsb, static_cast<uint8_t>(timeout & 0xFF));
+
+	_shadow.modem_config2 &= 0xFC;
+	_shadow.modem_config2 |= static_cast<uint8_t>((timeout >> 8) & 0x03);
+	write_config(lora::RegisterAddress::RegModemConfig2, _shadow.modem_config2);
+
+	this->_timeout = timeout;
+}
+
+
+/**
+ * @brief Sets the header mode for LoRa communication in the SX1278 LoRa transceiver.
+ *
+ * This function sets the header mode for LoRa communication in the SX1278 LoRa transceiver
+ * by configuring the ModemConfig1 register.
+ *startReceive
+ * @param header_mode The desired header mode to be set (EXPLICIT or IMPLICIT).
+ *
+ * @note The header mode bit is updated in the ModemConfig1 shadow, which is then written to the chip.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_header_mode(radio::sx1278::lora::HeaderMode header_mode) {
+	// SF6 requires implicit header mode
+	if(this->_spreading_factor == lora::SpreadingFactor::SF_6)
+		header_mode = lora::HeaderMode::IMPLICIT;
+
+	if(header_mode == lora::HeaderMode::EXPLICIT) {
+		_shadow.modem_config1 &= 0xFE;
+	} else {
+		_shadow.modem_config1 |= 0x01;
+	}
+	write_config(lora::RegisterAddress::RegModemConfig1, _shadow.modem_config1);
+
+	this->_header_mode = header_mode;
+}
+
+/**
+ * @brief Sets the LNA (Low-Noise Amplifier) gain for the SX1278 LoRa transceiver.
+ *
+ * This function sets the LNA (Low-Noise Amplifier) gain for the SX1278 LoRa transceiver
+ * by configuring the Lna register.
+ *
+ * @param lna_gain The desired LNA gain to be set.
+ *
+ * @note The LNA gain bits are updated in the Lna shadow, which is then written to the chip.
+ */
+
+// TODO: crosscheck how and if this function is necessary in user facing format
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_lna_gain(radio::sx1278::lora::LNAGain lna_gain) {
+	_shadow.lna &= 0x1F;
+	_shadow.lna |= static_cast<uint8_t>(lna_gain) << 5;
+	write_config(RegisterAddress::RegLna, _shadow.lna);
+
+	this->_lna_gain = lna_gain;
+}
+
+/**
+ * @brief Sets the whole LoRa modem configuration in one pass.
+ *
+ * This function computes ModemConfig1, ModemConfig2 and ModemConfig3 together and writes them with the
+ * SF-dependent detection registers in a single batch, so the contiguous ModemConfig1/ModemConfig2 block goes out
+ * as one burst and the modem never runs with a half-applied profile.
+ *
+ * @param spreading_factor The desired spreading factor.
+ * @param bandwidth The desired bandwidth.
+ * @param coding_rate The desired coding rate.
+ * @param header_mode The desired header mode (forced to IMPLICIT for SF6).
+ * @param crc The desired payload CRC configuration.
+ *
+ * @note LowDataRateOptimize follows SF and BW, see update_low_data_rate_optimize().
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::set_modem_config(
+		lora::SpreadingFactor spreading_factor,
+		lora::Bandwidth bandwidth,
+		lora::CodingRate coding_rate,
+		lora::HeaderMode header_mode,
+		lora::PayloadCRC crc
+) {
+	RegisterBatch batch;
+	bool own_batch = (_batch == nullptr);
+	if(own_batch) {
+		_batch = &batch;
+	}
+
+	set_spreading_factor(spreading_factor);
+	set_bandwidth(bandwidth);
+	set_coding_rate(coding_rate);
+	set_header_mode(header_mode);
+	set_payload_crc(crc);
+
+	if(own_batch) {
+		_batch = nullptr;
+		commit(batch);
+	}
+}
+
+/**
+ * @brief Writes a batch of register values to the SX1278 LoRa transceiver.
+ *
+ * Every run of adjacent registers in the batch is sent as one auto-increment burst, in address order.
+ * The batch is empty afterwards.
+ *
+ * @param batch The register writes to flush.
+ *
+ * @note Registers shadowed by the driver (OpMode, ModemConfig, Lna, ...) should be changed through the setters,
+ *       otherwise the shadow goes stale until resync().
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::commit(RegisterBatch& batch) {
+	batch.for_each_run([this](uint8_t address, const uint8_t* values, uint8_t length) {
+		if(length == 1) {
+			SPI_write(address, values[0]);
+		} else {
+			SPI_BurstWrite(address, values, length);
+		}
+	});
+	batch.clear();
+}
+
+/**
+ * @brief Writes a configuration register, or records it when a batch is being collected.
+ */
+
+template <typename Transport, typename Clock>
+template <typename RegAddr>
+void radio::sx1278::SX1278<Transport, Clock>::write_config(RegAddr addr, uint8_t value) {
+	if(_batch != nullptr) {
+		_batch->write(addr, value);
+	} else {
+		SPI_write(addr, value);
+	}
+}
+
+/**
+ * @brief Reloads the register shadow from the SX1278 LoRa transceiver.
+ *
+ * The setters keep the configuration registers in a RAM shadow and only write them, so the shadow has to
+ * match the chip. This function reads the shadowed registers back; call it after anything that changes
+ * them behind the driver's back (external reset, brown-out, direct register access).
+ *
+ * The mode the DIO0 handler dispatches on and the modem settings the airtime and event times are computed from
+ * (spreading factor, bandwidth, coding rate, header mode, payload CRC, preamble length, LNA gain) are decoded from
+ * the same registers.
+ *
+ * @return Status::OK if all registers were read, Status::ERROR otherwise (the shadow is left unchanged).
+ */
+
+template <typename Transport, typename Clock>
+radio::sx1278::Status radio::sx1278::SX1278<Transport, Clock>::resync() {
+	RegisterShadow shadow{};
+	uint8_t modem_config[2];
+	uint8_t dio_mapping[2];
+	uint8_t preamble[2];
+
+	auto op_mode = SPI_read<uint8_t>(RegisterAddress::RegOpMode);
+	auto pa_config = SPI_read<uint8_t>(RegisterAddress::RegPaConfig);
+	auto lna = SPI_read<uint8_t>(RegisterAddress::RegLna);
+	auto modem_config3 = SPI_read<uint8_t>(lora::RegisterAddress::RegModemConfig3);
+	auto detect_optimize = SPI_read<uint8_t>(lora::RegisterAddress::RegDetectOptimize);
+
+	if(!op_mode.has_value() || !pa_config.has_value() || !lna.has_value() ||
+	   !modem_config3.has_value() || !detect_optimize.has_value() ||
+	   !SPI_burstRead(lora::RegisterAddress::RegModemConfig1, modem_config, sizeof(modem_config)) ||
+	   !SPI_burstRead(RegisterAddress::RegDioMapping1, dio_mapping, sizeof(dio_mapping)) ||
+	   !SPI_burstRead(lora::RegisterAddress::RegPreambleMsb, preamble, sizeof(preamble))) {
+		return Status::ERROR;
+	}
+
+	shadow.op_mode = op_mode.value();
+	shadow.pa_config = pa_config.value();
+	shadow.lna = lna.value();
+	shadow.modem_config1 = modem_config[0];
+	shadow.modem_config2 = modem_config[1];
+	shadow.modem_config3 = modem_config3.value();
+	shadow.detect_optimize = detect_optimize.value();
+	shadow.dio_mapping1 = dio_mapping[0];
+	shadow.dio_mapping2 = dio_mapping[1];
+	_shadow = shadow;
+
+	this->_current_mode = static_cast<lora::Mode>(shadow.op_mode & 0x07);
+	this->_bandwidth = static_cast<lora::Bandwidth>(shadow.modem_config1 >> 4);
+	this->_coding_rate = static_cast<lora::CodingRate>((shadow.modem_config1 >> 1) & 0x07);
+	this->_header_mode = (shadow.modem_config1 & 0x01) ? lora::HeaderMode::IMPLICIT : lora::HeaderMode::EXPLICIT;
+	this->_spreading_factor = static_cast<lora::SpreadingFactor>(shadow.modem_config2 >> 4);
+	this->_crc = (shadow.modem_config2 & 0x04) ? lora::PayloadCRC::ON : lora::PayloadCRC::OFF;
+	this->_preamble_length = static_cast<uint16_t>((preamble[0] << 8) | preamble[1]);
+	this->_lna_gain = static_cast<lora::LNAGain>(shadow.lna >> 5);
+
+	return Status::OK;
+}
+
+/**
+ * @brief Gets the current operating mode of the SX1278 LoRa transceiver.
+ *
+ * This function retrieves and returns the current operating mode of the SX1278 LoRa transceiver.
+ *
+ * @return The current operating mode as a value from the lora::Mode enum.
+ */
+template <typename Transport, typename Clock>
+radio::sx1278::lora::Mode radio::sx1278::SX1278<Transport, Clock>::get_mode() {
+	return _current_mode;
+}
+
+/**
+ * @brief Gets the version information from the SX1278 LoRa transceiver.
+ *
+ * This function retrieves the version information from the SX1278 LoRa transceiver by reading the Version register.
+ *
+ * @return The version information as an unsigned 8-bit integer, or 0 if the read operation fails.
+ */
+
+template <typename Transport, typename Clock>
+uint8_t radio::sx1278::SX1278<Transport, Clock>::get_version() {
+	auto reg_value = SPI_read<uint8_t>(RegisterAddress::RegVersion);
+
+	if(reg_value.has_value()) {
+		return reg_value.value();
+	}
+	return 0;
+}
+
+/**
+ * @brief Takes IRQ flags, packet SNR and packet RSSI out of the RX status burst (0x10 .. 0x1A).
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::decode_rx_status(const uint8_t (&status)[rx_status_length]) {
+	_rx_irq_flags = status[2];
+	_rx_status.snr = static_cast<int8_t>(status[9]);
+	_rx_status.rssi = lora::packet_rssi(status[10], _rx_status.snr, this->_frequency);
+}
+
+/**
+ * @brief Gets the Received Signal Strength Indicator (RSSI) from the SX1278 LoRa transceiver.
+ *
+ * This function retrieves the Received Signal Strength Indicator (RSSI) from the SX1278 LoRa transceiver
+ * by reading the RSSI Value register.
+ *
+ * @return The RSSI value as an integer, or 0 if the read operation fails.
+ *
+ * @note The offset follows the RF port of the configured frequency (-157 dB HF, -164 dB LF), see lora::rssi_offset().
+ * @note The returned RSSI value is an integer representing the signal strength in dBm.
+ * @note This is the current channel RSSI; the strength of the last packet is in get_packet_status().
+ */
+
+template <typename Transport, typename Clock>
+int radio::sx1278::SX1278<Transport, Clock>::get_RSSI() {
+	auto reg_value = SPI_read<uint8_t>(lora::RegisterAddress::RegRssiValue);
+
+	if(reg_value.has_value()) {
+		return lora::rssi_offset(this->_frequency) + reg_value.value();
+	}
+	return 0;
+
+}
+
+
+/**
+ * @brief Clears interrupt flags in the SX1278 LoRa transceiver.
+ *
+ * This function clears interrupt flags in the SX1278 LoRa transceiver by writing 0xFF to the IrqFlags register.
+ */
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::clear_irq_flags(IrqFlags flags) {
+	SPI_write(lora::RegisterAddress::RegIrqFlags, static_cast<uint8_t>(flags));
+}
+
+
+/**
+ * @brief Initializes and configures the SX1278 LoRa transceiver.
+ *
+ * This function initializes and configures the SX1278 LoRa transceiver with various settings such as frequency,
+ * power, spreading factor, bandwidth, coding rate, header mode, LNA gain, CRC, preamble length, timeout, and OCP.
+ *
+ * @param frequency The desired operating frequency in Hertz (Hz).
+ * @param power The desired transmit power level.
+ * @param spreading_factor The desired spreading factor for LoRa modulation.
+ * @param bandwidth The desired bandwidth for LoRa modulation.
+ * @param coding_rate The desired coding rate for LoRa modulation.
+ * @param header_mode The desired header mode (EXPLICIT or IMPLICIT).
+ * @param lna_gain The desired LNA (Low-Noise Amplifier) gain.
+ * @param crc The desired payload CRC configuration (ON or OFF).
+ * @param preamble_length The desired preamble length in number of symbols.
+ * @param timeout The desired timeout value in symbols.
+ * @param max_current The desired Over-Current Protection (OCP) value in milliamperes (mA).
+ *
+ * @return The initialization status (OK or ERROR).
+ *
+ * @note The function performs various configuration steps for the SX1278 transceiver,
+ *       including setting the operating mode, frequency, power, modulation parameters, and more.
+ * @note Apart from the LoRa mode switch, the configuration is collected in a RegisterBatch and flushed as
+ *       one burst per run of adjacent registers.
+ * @note It also sets the DIO mapping for RxDone and sets the transceiver to STDBY mode.
+ * @note Depending on the version of the transceiver, it sets the mode to RXCONTINUOUS or RXSINGLE.
+ */
+
+template <typename Transport, typename Clock>
+radio::sx1278::Status radio::sx1278::SX1278<Transport, Clock>::init(
+		uint32_t frequency,
+		lora::Power power,
+		lora::SpreadingFactor spreading_factor,
+		lora::Bandwidth bandwidth,
+		lora::CodingRate coding_rate,
+		lora::HeaderMode header_mode,
+		lora::LNAGain lna_gain,
+		lora::PayloadCRC crc,
+		uint16_t preamble_length,
+		uint16_t timeout,
+		uint8_t max_current
+) {
+	reset();
+
+	/** Load register shadow with the post-reset values **/
+	if(resync() != Status::OK) {
+		return Status::ERROR;
+	}
+
+	/** Set LoRa mode, LongRangeMode can only be changed in SLEEP **/
+	_shadow.op_mode = (_shadow.op_mode & 0x78) | 0x80 | static_cast<uint8_t>(lora::Mode::SLEEP);
+	SPI_write(RegisterAddress::RegOpMode, _shadow.op_mode);
+
+	/** Collect the configuration and send it as a few bursts **/
+	RegisterBatch batch;
+	_batch = &batch;
+
+	/** Set frequency **/
+	set_frequency(frequency);
+
+	/** Set output power gain **/
+	set_power(power);
+
+	/** Set spreading factor, bandwidth, coding rate, header mode and CRC **/
+	set_modem_config(spreading_factor, bandwidth, coding_rate, header_mode, crc);
+
+	/** Set preamble length **/
+	set_preamble_length(preamble_length);
+
+	/** Set timeout **/
+	set_timeout(timeout);
+
+	/** Set OCP **/
+	set_ocp(max_current);
+
+	/** Set LNA gain **/
+	set_lna_gain(lna_gain);
+
+	/** DIO mapping: --> DIO: RxDone **/
+	_shadow.dio_mapping1 |= 0x3F;
+	write_config(RegisterAddress::RegDioMapping1, _shadow.dio_mapping1);
+
+	/** RX/TX FIFO **/
+	// The entire FIFO is used for TX/RX operation until set_fifo_slots() splits it
+	write_config(lora::RegisterAddress::RegFifoRxBaseAddr, static_cast<uint8_t>(0x00));
+	write_config(lora::RegisterAddress::RegFifoTxBaseAddr, static_cast<uint8_t>(0x00));
+
+	_batch = nullptr;
+	commit(batch);
+
+	/** Set mode to standby **/
+	set_mode(lora::Mode::STDBY);
+
+	if(get_version() == 0x12) {
+		return Status::OK;
+
+	} else {
+		return Status::ERROR;
+	}
+
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::on_dio0_irq() {
+	on_dio0_irq(Clock::now());
+}
+
+/**
+ * @brief DIO0 handler with the edge time captured elsewhere, e.g. by a timer input capture on the DIO0 pin,
+ *        converted to Clock ticks; removes the interrupt latency from the event times.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::on_dio0_irq(uint32_t captured_ticks) {
+	_dio0_ticks = captured_ticks;
+
+	// TODO: call RX DONE handler and stop radio
+	if (this->_current_mode == lora::Mode::TX) {
+		this->_handle_txdone_irq();
+	}
+	else if (this->_current_mode == lora::Mode::RXCONTINUOUS) {		
+		this->_handle_rxdone_irq();
+	}
+#ifdef SX1278_COROUTINES
+	else if (this->_current_mode == lora::Mode::CAD) {
+		this->_handle_caddone_irq();
+	}
+#endif
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::_handle_txdone_irq() {
+	// TxDone has to go, otherwise DIO0 is already high when it is mapped to TxDone again; the RX flags are cleared
+	// as well, so retransmit() can tell whether a packet has been written over the FIFO since this transmission
+	this->clear_irq_flags(IrqFlags::All);
+
+	_tx_time = event_time(_dio0_ticks, _tx_length);
+	/** the preamble went out one time on air before TxDone **/
+	uint32_t tx_start = _tx_time.done - us_to_ticks<Clock>(get_time_on_air_us(_tx_length));
+	_tx_latency.start_ticks = static_cast<int32_t>(tx_start - _tx_request_ticks);
+	if (on_tx_done != nullptr)
+		on_tx_done(_tx_time);
+
+	if (_tx_count != 0) {
+		_tx_request_ticks = Clock::now();
+		TxFrame& frame = _tx_queue[_tx_head];
+		_tx_head = (_tx_head + 1) % tx_queue_depth;
+		_tx_count = _tx_count - 1;
+		/** frees the buffer of the frame that just went out, the slot is not reused before this TxDone returns **/
+		_tx_on_air = std::move(frame.frame);
+
+		/** The chip falls back to STDBY on TxDone by itself, only the shadow has to follow **/
+		_shadow.op_mode = (_shadow.op_mode & 0xF8) | static_cast<uint8_t>(lora::Mode::STDBY);
+		this->_current_mode = lora::Mode::STDBY;
+		this->load_and_transmit(frame.data, frame.length);
+		return;
+	}
+	_tx_active = false;
+	_tx_on_air.release();
+
+	this->set_mode(lora::Mode::RXCONTINUOUS);
+
+#ifdef SX1278_COROUTINES
+	if (_coro_operation == CoroOperation::TRANSMIT)
+		this->coro_resume(true);
+#endif
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::_handle_rxdone_irq() {
+	_fifo_tx_valid = false;
+
+#ifdef SX1278_COROUTINES
+	if (_coro_operation == CoroOperation::RECEIVE) {
+		// the awaiting coroutine consumes the packet, it is resumed once the FIFO drain completes; on_tick() leaves
+		// it alone meanwhile, the drain writes into its buffer
+		_coro_rx_draining = true;
+		if (!this->getReceivedDataAsync(_async_rx_data, _async_rx_length, nullptr)) {
+			_coro_rx_draining = false;
+			this->coro_resume(false);
+		}
+		return;
+	}
+#endif
+#ifdef SX1278_RX_RING
+	this->rx_ring_drain();
+#endif
+	if (this->on_rx != nullptr)
+		this->on_rx();
+
+#ifdef SX1278_SPI_DMA
+	if (this->is_dma_busy())
+		return; // FIFO drain still on the bus, RX is re-armed from on_spi_dma_complete()
+#endif
+	this->startReceive();
+}
+
+#ifdef SX1278_RX_RING
+/**
+ * @brief Drains the frame behind RxDone straight into a free slot of the RX ring, with its IRQ flags.
+ *
+ * If the ring is full the frame is dropped and counted in overflows(); a frame that cannot be read is counted in
+ * drops(). Either way the IRQ flags are cleared so DIO0 can rise again.
+ *
+ * @note In implicit header mode the frame length is the one configured in RegPayloadLength.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::rx_ring_drain() {
+	RxPacket* packet = _rx_ring.producer_slot();
+	if(packet == nullptr) {
+		_rx_ring.count_overflow();
+		this->clear_irq_flags();
+		return;
+	}
+
+	uint8_t length = 0;
+	if(this->_header_mode == lora::HeaderMode::IMPLICIT) {
+		auto payload_length = SPI_read<uint8_t>(lora::RegisterAddress::RegPayloadLength);
+		if(payload_length)
+			length = payload_length.value();
+	}
+
+	length = this->getReceivedData(packet->data, length);
+	if(length == 0) {
+		_rx_ring.count_drop();
+		this->clear_irq_flags();
+		return;
+	}
+
+#ifdef SX1278_SPI_DMA
+	if(this->is_dma_busy()) {
+		_rx_ring_draining = true; // published once the drain has landed
+		return;
+	}
+#endif
+	this->rx_ring_publish(length);
+}
+
+/**
+ * @brief Fills in the metadata of the slot drained by rx_ring_drain() and hands it to the consumer.
+ *
+ * With SX1278_SPI_DMA this runs after the cache invalidate of the drained payload, the status of the packet is still
+ * held in _rx_irq_flags / _rx_status / _rx_time as the next RxDone cannot come before the IRQ flags are cleared.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::rx_ring_publish(uint8_t length) {
+	RxPacket* packet = _rx_ring.producer_slot();
+	packet->length = length;
+	packet->irq_flags = _rx_irq_flags;
+	packet->status = _rx_status;
+	packet->time = _rx_time;
+	_rx_ring.produce();
+}
+#endif
+
+#ifdef SX1278_SPI_DMA
+/**
+ * @brief Finishes a FIFO DMA transfer started by startTransmit() or getReceivedData().
+ *
+ * Releases NSS and completes the pending operation: a FIFO load switches the transceiver to TX mode,
+ * a FIFO drain clears the IRQ flags and hands the received data to on_rx_frame / on_rx_data.
+ *
+ * @note Dispatched from on_spi_complete(), which the SPI transfer complete callbacks have to call.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::on_spi_dma_complete() {
+	transport.deselect();
+
+	auto transfer = _dma_transfer;
+	_dma_transfer = DmaTransfer::NONE;
+
+	if(transfer == DmaTransfer::FIFO_LOAD) {
+		set_mode(lora::Mode::TX);
+	} else if(transfer == DmaTransfer::FIFO_DRAIN) {
+		transport.read_dma_complete(_dma_data, _dma_length);
+		if(_rx_pending_frame) {
+			_rx_pending_frame->length = _dma_length;
+			FrameHandle frame = std::move(_rx_pending_frame);
+			if(this->on_rx_frame != nullptr)
+				this->on_rx_frame(std::move(frame));
+		}
+#ifdef SX1278_RX_RING
+		if(_rx_ring_draining) {
+			_rx_ring_draining = false;
+			rx_ring_publish(_dma_length);
+		}
+#endif
+		clear_irq_flags();
+		if(this->on_rx_data != nullptr)
+			this->on_rx_data(_dma_data, _dma_length);
+		startReceive();
+	}
+}
+
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::is_dma_busy() const {
+	return _dma_transfer != DmaTransfer::NONE;
+}
+#endif
+
+/**
+ * @brief Queues a non-blocking transmission of the given data.
+ *
+ * The same register sequence as startTransmit() (STDBY, FIFO pointer, payload length, FIFO load, TX) is queued on the
+ * interrupt-driven SPI engine and the function returns immediately. The frame goes to the same on-the-fly TX area,
+ * so staged slots it wraps into are dropped as with startTransmit(). get_tx_done_time() and the start latency are
+ * taken when the TX OpMode write completes, before on_loaded is called.
+ *
+ * @param data A pointer to the data to be transmitted; must stay valid until on_loaded is called.
+ * @param length The length of the data to be transmitted.
+ * @param on_loaded Optional callback, called from the SPI interrupt once the transceiver is in TX mode.
+ *
+ * @return True if the transmission was queued, false if the SPI queue had no room for it.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::startTransmitAsync(const uint8_t* data, uint8_t length, void(*on_loaded)(void)) {
+	if(spi_queue_free() < 8)
+		return false;
+
+	_async_on_loaded = on_loaded;
+	_async_tx_length = length;
+	_tx_request_ticks = Clock::now();
+
+	queue_mode(lora::Mode::STDBY);
+	if(claim_tx_area(length)) {
+		queue_write(lora::RegisterAddress::RegFifoTxBaseAddr, _fifo_tx_base);
+	}
+	queue_write(lora::RegisterAddress::RegFifoAddrPtr, _fifo_rx_base);
+	queue_write(lora::RegisterAddress::RegPayloadLength, length);
+	queue_burst_write(RegisterAddress::RegFifo, data, length);
+	queue_mode(lora::Mode::TX, &SX1278::_async_tx_loaded);
+
+	return true;
+}
+
+/**
+ * @brief Queues a non-blocking switch to RXCONTINUOUS mode.
+ *
+ * @return True if the mode change was queued, false if the SPI queue had no room for it.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::startReceiveAsync() {
+	if(spi_queue_free() < 2)
+		return false;
+
+	queue_mode(lora::Mode::RXCONTINUOUS);
+	return true;
+}
+
+/**
+ * @brief Queues a non-blocking read of the last received packet.
+ *
+ * Mirrors getReceivedData(): the status registers are read first in one burst, and from its completion hook the FIFO drain and
+ * the IRQ flag clear are queued. on_data is called from the SPI interrupt with the number of bytes read, or with 0 if
+ * nothing was read: get_rx_irq_flags() then lacks RxDone if no packet was waiting, and has it if the length is unknown
+ * in implicit header mode. A packet with PayloadCrcError set is read all the same, check get_rx_irq_flags().
+ *
+ * @param data A pointer to the buffer where received data will be stored; must stay valid until on_data is called.
+ * @param length The number of bytes to read in implicit header mode; in explicit header mode the buffer size
+ *        (0 for no limit), longer packets are truncated.
+ * @param on_data Callback receiving the data.
+ *
+ * @return True if the read was queued, false if the SPI queue had no room for it.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::getReceivedDataAsync(uint8_t* data, uint8_t length, void(*on_data)(uint8_t* data, uint8_t length)) {
+	if(spi_queue_free() < 1 + rx_drain_slots)
+		return false;
+
+	_async_rx_data = data;
+	_async_rx_length = length;
+	_async_on_data = on_data;
+
+	spi_reserve(rx_drain_slots); // the drain is queued from the status hook, nothing queued meanwhile may take its slots
+	/** RegFiFoRxCurrentAddr .. RegPktRssiValue in one burst **/
+	queue_burst_read(lora::RegisterAddress::RegFiFoRxCurrentAddr, _async_rx_status, sizeof(_async_rx_status),
+	                 &SX1278::_async_rx_status_read);
+
+	return true;
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::_async_tx_loaded(const SpiTransaction&) {
+	_fifo_tx_valid = true;
+	// the frame is on air from here, its length times TxDone and the event times
+	_tx_length = _async_tx_length;
+	tx_started(false);
+	if(_async_on_loaded != nullptr)
+		_async_on_loaded();
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::_async_rx_status_read(const SpiTransaction&) {
+	spi_unreserve(rx_drain_slots); // set aside by getReceivedDataAsync()
+	decode_rx_status(_async_rx_status);
+	_async_irq_flags = _rx_irq_flags;
+	if(_async_irq_flags & IrqFlags::RxDone)
+		_fifo_tx_valid = false; // the packet was written over the last TX payload
+
+	uint8_t nb_bytes = _async_rx_status[3];
+	_rx_time = event_time(_dio0_ticks, (this->_header_mode == lora::HeaderMode::EXPLICIT) ? nb_bytes : _async_rx_length);
+	if(this->_header_mode == lora::HeaderMode::EXPLICIT &&
+	   (_async_rx_length == 0 || nb_bytes < _async_rx_length)) {
+		_async_rx_length = nb_bytes; /** never overrun the caller's buffer **/
+	}
+
+	if(!(_async_irq_flags & IrqFlags::RxDone) || _async_rx_length == 0) {
+		_async_rx_complete(0); // nothing read, get_rx_irq_flags() tells a missing RxDone from an unknown length
+		return;
+	}
+
+	queue_write(lora::RegisterAddress::RegFifoAddrPtr, _async_rx_status[0]);
+	queue_burst_read(RegisterAddress::RegFifo, _async_rx_data, _async_rx_length);
+	queue_write(lora::RegisterAddress::RegIrqFlags, static_cast<uint8_t>(IrqFlags::All), &SX1278::_async_rx_finished);
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::_async_rx_finished(const SpiTransaction&) {
+	_async_rx_complete(_async_rx_length);
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::_async_rx_complete(uint8_t length) {
+	if(_async_on_data != nullptr)
+		_async_on_data(_async_rx_data, length);
+
+#ifdef SX1278_COROUTINES
+	if(_coro_operation == CoroOperation::RECEIVE) {
+		_coro_rx_length = length;
+		_coro_rx_draining = false;
+		coro_resume(length > 0);
+	}
+#endif
+}
+
+/**
+ * @brief Queues the register writes of set_mode() on the SPI engine.
+ *
+ * The shadow and the current mode are updated immediately, the chip follows once the queue reaches the writes.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::queue_mode(lora::Mode mode, void (SX1278::*on_complete)(const SpiTransaction&)) {
+	uint8_t dio_mapping = _shadow.dio_mapping1;
+	if(mode == lora::Mode::TX || mode == lora::Mode::FSTX) {
+		dio_mapping = 0x40; /** set DIO0 to TxDone, already in FSTX so FSTX->TX is a single OpMode write **/
+	} else if(mode == lora::Mode::RXCONTINUOUS) {
+		dio_mapping = 0x00; /** set DIO0 to RxDone **/
+	} else if(mode == lora::Mode::CAD) {
+		dio_mapping = 0x80; /** set DIO0 to CadDone **/
+	}
+
+	if(dio_mapping != _shadow.dio_mapping1) {
+		_shadow.dio_mapping1 = dio_mapping;
+		queue_write(RegisterAddress::RegDioMapping1, _shadow.dio_mapping1);
+	}
+
+	if(mode == lora::Mode::SLEEP) {
+		drop_fifo_contents(); /** FIFO is not kept in SLEEP **/
+	}
+
+	_shadow.op_mode &= 0xF8; /** clear mode bits **/
+	_shadow.op_mode |= static_cast<uint8_t>(mode); /** set mode bits **/
+	queue_write(RegisterAddress::RegOpMode, _shadow.op_mode, on_complete);
+
+	this->_current_mode = mode;
+}
+
+template <typename Transport, typename Clock>
+template <typename RegAddr>
+void radio::sx1278::SX1278<Transport, Clock>::queue_write(RegAddr addr, uint8_t value, void (SX1278::*on_complete)(const SpiTransaction&)) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+
+	SpiTransaction transaction{};
+	transaction.header[0] = static_cast<uint8_t>(addr) | 0x80; /** set MSB to 1 to indicate write **/
+	transaction.header[1] = value;
+	transaction.header_length = 2;
+	transaction.on_complete = on_complete;
+	spi_enqueue(transaction);
+}
+
+template <typename Transport, typename Clock>
+template <typename RegAddr>
+void radio::sx1278::SX1278<Transport, Clock>::queue_read(RegAddr addr, void (SX1278::*on_complete)(const SpiTransaction&)) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+
+	SpiTransaction transaction{};
+	transaction.header[0] = static_cast<uint8_t>(addr) & 0x7F; /** set MSB to 0 to indicate read **/
+	transaction.header_length = 2;
+	transaction.on_complete = on_complete;
+	spi_enqueue(transaction);
+}
+
+template <typename Transport, typename Clock>
+template <typename RegAddr>
+void radio::sx1278::SX1278<Transport, Clock>::queue_burst_write(RegAddr addr, const uint8_t* data, uint8_t length, void (SX1278::*on_complete)(const SpiTransaction&)) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+
+	SpiTransaction transaction{};
+	transaction.header[0] = static_cast<uint8_t>(addr) | 0x80; /** set MSB to 1 to indicate write **/
+	transaction.header_length = 1;
+	transaction.tx_payload = data;
+	transaction.payload_length = length;
+	transaction.on_complete = on_complete;
+	spi_enqueue(transaction);
+}
+
+template <typename Transport, typename Clock>
+template <typename RegAddr>
+void radio::sx1278::SX1278<Transport, Clock>::queue_burst_read(RegAddr addr, uint8_t* data, uint8_t length, void (SX1278::*on_complete)(const SpiTransaction&)) {
+	static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+
+	SpiTransaction transaction{};
+	transaction.header[0] = static_cast<uint8_t>(addr) & 0x7F; /** set MSB to 0 to indicate read **/
+	transaction.header_length = 1;
+	transaction.rx_payload = data;
+	transaction.payload_length = length;
+	transaction.on_complete = on_complete;
+	spi_enqueue(transaction);
+}
+
+template <typename Transport, typename Clock>
+uint8_t radio::sx1278::SX1278<Transport, Clock>::spi_queue_free() const {
+	return spi_queue_depth - _spi_count - _spi_reserved;
+}
+
+/**
+ * @brief Sets queue slots aside for transactions that have to be queued later, from a completion hook or an IRQ
+ *        handler, so nothing queued in between can take them.
+ *
+ * @note Callers check spi_queue_free() up front; the slots are handed back with spi_unreserve() right before they are
+ *       queued.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::spi_reserve(uint8_t slots) {
+	auto state = transport.critical_enter();
+	_spi_reserved = _spi_reserved + slots;
+	transport.critical_exit(state);
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::spi_unreserve(uint8_t slots) {
+	auto state = transport.critical_enter();
+	_spi_reserved = _spi_reserved - slots;
+	transport.critical_exit(state);
+}
+
+/**
+ * @brief Appends a transaction to the SPI queue and starts the bus if it is idle.
+ *
+ * @note Safe to call from thread context and from completion hooks; the queue is guarded by the transport's
+ *       critical section. Callers check spi_queue_free() up front.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::spi_enqueue(const SpiTransaction& transaction) {
+	auto state = transport.critical_enter();
+
+	assert(_spi_count < spi_queue_depth);
+	_spi_queue[(_spi_head + _spi_count) % spi_queue_depth] = transaction;
+	_spi_count = _spi_count + 1;
+
+	if(_spi_busy) {
+		transport.critical_exit(state);
+		return;
+	}
+
+	_spi_busy = true;
+	_spi_payload_phase = false;
+	transport.select();
+	bool started = spi_start_phase(_spi_queue[_spi_head]);
+	transport.critical_exit(state);
+
+	if(!started) {
+		spi_advance(); /** transport ran the phase blocking **/
+	}
+}
+
+/**
+ * @brief Starts the current phase of a transaction.
+ *
+ * @return True if the transport started an interrupt-driven transfer, false if it was run blocking.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::spi_start_phase(SpiTransaction& transaction) {
+	if(!_spi_payload_phase) {
+		if(transport.transfer_async(transaction.header, transaction.header_rx, transaction.header_length))
+			return true;
+		transport.transfer(transaction.header, transaction.header_rx, transaction.header_length);
+		return false;
+	}
+
+	if(transport.transfer_async(transaction.tx_payload, transaction.rx_payload, transaction.payload_length))
+		return true;
+	if(transaction.tx_payload != nullptr) {
+		transport.write(transaction.tx_payload, transaction.payload_length);
+	} else {
+		transport.read(transaction.rx_payload, transaction.payload_length);
+	}
+	return false;
+}
+
+/**
+ * @brief Moves the SPI engine past a finished phase.
+ *
+ * Starts the payload phase if the transaction has one, otherwise releases NSS, runs the completion hook and starts
+ * the next queued transaction. Phases the transport runs blocking are advanced in this loop rather than recursively.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::spi_advance() {
+	while(true) {
+		SpiTransaction& current = _spi_queue[_spi_head];
+
+		if(!_spi_payload_phase && current.payload_length > 0) {
+			_spi_payload_phase = true;
+			if(spi_start_phase(current))
+				return;
+			continue;
+		}
+
+		transport.deselect();
+
+		SpiTransaction done = current;
+		auto state = transport.critical_enter();
+		_spi_head = (_spi_head + 1) % spi_queue_depth;
+		_spi_count = _spi_count - 1;
+		transport.critical_exit(state);
+
+		if(done.on_complete != nullptr)
+			(this->*done.on_complete)(done); /** _spi_busy is still set, so transactions queued here wait for this loop **/
+
+		state = transport.critical_enter();
+		if(_spi_count == 0) {
+			_spi_busy = false;
+			transport.critical_exit(state);
+			return;
+		}
+		transport.critical_exit(state);
+
+		_spi_payload_phase = false;
+		transport.select();
+		if(spi_start_phase(_spi_queue[_spi_head]))
+			return;
+	}
+}
+
+/**
+ * @brief Handles the end of an interrupt-driven SPI transfer.
+ *
+ * @note Must be called from HAL_SPI_TxCpltCallback, HAL_SPI_RxCpltCallback and HAL_SPI_TxRxCpltCallback
+ *       for the SPI handle used by this driver.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::on_spi_complete() {
+#ifdef SX1278_SPI_DMA
+	if(is_dma_busy()) {
+		on_spi_dma_complete();
+		return;
+	}
+#endif
+	if(_spi_busy) {
+		spi_advance();
+	}
+}
+
+/**
+ * @brief Checks whether the SPI engine has finished all queued transactions.
+ *
+ * @note Blocking driver calls must not be made while the engine is busy, they would share the bus with it.
+ */
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::is_spi_idle() const {
+	return !_spi_busy;
+}
+
+#ifdef SX1278_COROUTINES
+/**
+ * @brief Awaitable transmission of the given data.
+ *
+ * @param data The data to be transmitted; must stay valid until the awaiting coroutine resumes.
+ *
+ * @return An awaitable resuming with true on TxDone, or immediately with false if the transmission could not be queued.
+ */
+template <typename Transport, typename Clock>
+radio::sx1278::TransmitAwaiter<radio::sx1278::SX1278<Transport, Clock>> radio::sx1278::SX1278<Transport, Clock>::transmit(etl::span<const uint8_t> data) {
+	return {*this, data};
+}
+
+/**
+ * @brief Awaitable reception of one packet.
+ *
+ * @param buffer Buffer for the packet; in implicit header mode its size is the expected payload length.
+ * @param deadline Time (in the time base passed to on_tick()) after which the receive gives up.
+ *
+ * @return An awaitable resuming with the packet length, or nullopt on timeout or when the packet could not be read
+ *         (get_rx_irq_flags() tells why).
+ */
+template <typename Transport, typename Clock>
+radio::sx1278::ReceiveAwaiter<radio::sx1278::SX1278<Transport, Clock>> radio::sx1278::SX1278<Transport, Clock>::receive(etl::span<uint8_t> buffer, uint32_t deadline) {
+	return {*this, buffer, deadline};
+}
+
+/**
+ * @brief Awaitable Channel Activity Detection.
+ *
+ * @return An awaitable resuming with true if LoRa activity was detected on the channel.
+ */
+template <typename Transport, typename Clock>
+radio::sx1278::CadAwaiter<radio::sx1278::SX1278<Transport, Clock>> radio::sx1278::SX1278<Transport, Clock>::cad() {
+	return {*this};
+}
+
+/**
+ * @brief Expires a pending receive() whose deadline has passed.
+ *
+ * @param now Current time, in the time base of the deadline.
+ *
+ * @note A receive whose packet is already being drained is completed by the drain instead, even past the deadline;
+ *       check and claim happen under one critical section, so RxDone cannot start a drain in between.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::on_tick(uint32_t now) {
+	auto state = transport.critical_enter();
+	bool expired = _coro_operation == CoroOperation::RECEIVE && !_coro_rx_draining &&
+	               static_cast<int32_t>(now - _coro_deadline) >= 0;
+	auto waiter = _coro_waiter;
+	if(expired) {
+		_coro_waiter = nullptr;
+		_coro_operation = CoroOperation::NONE;
+	}
+	transport.critical_exit(state);
+
+	if(expired && waiter) {
+		_coro_result = false;
+		waiter.resume();
+	}
+}
+
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::coro_start_transmit(std::coroutine_handle<> handle, etl::span<const uint8_t> data) {
+	if(_coro_operation != CoroOperation::NONE || data.size() > 255) {
+		_coro_result = false;
+		return false;
+	}
+
+	_coro_waiter = handle;
+	_coro_operation = CoroOperation::TRANSMIT;
+	if(!startTransmitAsync(data.data(), static_cast<uint8_t>(data.size()))) {
+		_coro_operation = CoroOperation::NONE;
+		_coro_result = false;
+		return false;
+	}
+	return true;
+}
+
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::coro_start_receive(std::coroutine_handle<> handle, etl::span<uint8_t> buffer, uint32_t deadline) {
+	if(_coro_operation != CoroOperation::NONE) {
+		_coro_result = false;
+		return false;
+	}
+
+	_async_rx_data = buffer.data();
+	_async_rx_length = static_cast<uint8_t>(buffer.size() > 255 ? 255 : buffer.size());
+	_coro_deadline = deadline;
+	_coro_waiter = handle;
+	_coro_operation = CoroOperation::RECEIVE;
+
+	if(_current_mode != lora::Mode::RXCONTINUOUS && !startReceiveAsync()) {
+		_coro_operation = CoroOperation::NONE;
+		_coro_result = false;
+		return false;
+	}
+	return true;
+}
+
+template <typename Transport, typename Clock>
+bool radio::sx1278::SX1278<Transport, Clock>::coro_start_cad(std::coroutine_handle<> handle) {
+	if(_coro_operation != CoroOperation::NONE || spi_queue_free() < 3 + cad_done_slots) {
+		_coro_result = false;
+		return false;
+	}
+
+	_coro_waiter = handle;
+	_coro_operation = CoroOperation::CAD;
+	spi_reserve(cad_done_slots); // CadDone is always read and cleared, cad() never resumes without a verdict
+	queue_mode(lora::Mode::STDBY);
+	queue_mode(lora::Mode::CAD);
+	return true;
+}
+
+/**
+ * @brief Resumes the coroutine waiting on the radio, at most once per operation.
+ */
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::coro_resume(bool result) {
+	auto state = transport.critical_enter();
+	auto waiter = _coro_waiter;
+	bool pending = _coro_operation != CoroOperation::NONE;
+	_coro_waiter = nullptr;
+	_coro_operation = CoroOperation::NONE;
+	transport.critical_exit(state);
+
+	if(pending && waiter) {
+		_coro_result = result;
+		waiter.resume();
+	}
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::_handle_caddone_irq() {
+	if(_coro_operation == CoroOperation::CAD) {
+		spi_unreserve(cad_done_slots); // set aside by coro_start_cad()
+	} else if(spi_queue_free() < cad_done_slots) {
+		return; // no cad() waiting, e.g. CAD mode taken over by resync()
+	}
+	queue_read(lora::RegisterAddress::RegIrqFlags, &SX1278::_coro_cad_flags_read);
+	queue_write(lora::RegisterAddress::RegIrqFlags, static_cast<uint8_t>(IrqFlags::CadDone | IrqFlags::CadDetected),
+	            &SX1278::_coro_cad_cleared);
+}
+
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::_coro_cad_flags_read(const SpiTransaction& transaction) {
+	_coro_cad_detected = transaction.header_rx[1] & IrqFlags::CadDetected;
+}
+
+/** The coroutine resumes once CadDone is cleared, so whatever it starts next finds DIO0 low **/
+template <typename Transport, typename Clock>
+void radio::sx1278::SX1278<Transport, Clock>::_coro_cad_cleared(const SpiTransaction&) {
+	this->_current_mode = lora::Mode::STDBY; /** the chip drops back to STDBY once CAD is done **/
+	_shadow.op_mode = (_shadow.op_mode & 0xF8) | static_cast<uint8_t>(lora::Mode::STDBY);
+	coro_resume(_coro_cad_detected);
+}
+#endif
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_TPP
@@ -0,0 +1,195 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_AGGREGATION_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_AGGREGATION_HPP
+
+#include <cstdint>
+#include <cstring>
+
+#include <etl/optional.h>
+#include <etl/span.h>
+
+#include "SX1278_Airtime.hpp"
+
+namespace radio::sx1278 {
+	/**
+	 * Packing of small messages into shared frames, so they share one preamble, header and CRC.
+	 *
+	 * Frame format: [0xF3] followed by records [length] [message...], length 1..253.
+	 */
+	namespace aggregate {
+		static constexpr uint8_t kind = 0xF3;
+		static constexpr uint8_t max_frame = 255;
+		static constexpr uint8_t max_message = max_frame - 2;
+	}
+
+	/**
+	 * Sending side: collects messages until the frame is full or the oldest one reaches its deadline.
+	 *
+	 * The LoRa modem codes the payload in interleaver blocks, so the last block of a frame usually has room for a few
+	 * more bytes that cost no airtime. push_if_free() adds a message only if it fits there, which suits low priority
+	 * filler (status, housekeeping); free_bytes() tells how much room there is.
+	 * @code
+	 * aggregator.push(message, length, now);
+	 * if(aggregator.should_flush(now)) {
+	 *     auto frame = aggregator.flush();
+	 *     radio.startTransmit(frame.data(), frame.size());
+	 * }
+	 * @endcode
+	 *
+	 * @note Not interrupt safe; push and flush from the same context.
+	 */
+	class Aggregator {
+	public:
+		/**
+		 * @param max_delay Longest time a message may wait for company, in the time base of push() / should_flush().
+		 */
+		explicit Aggregator(uint32_t max_delay) : _max_delay(max_delay) {
+			clear();
+		};
+
+		/**
+		 * @brief Sets the modem settings used to find the free bytes of the last symbol block; the defaults are those
+		 *        of SX1278::init().
+		 */
+		void set_modem(
+				lora::SpreadingFactor spreading_factor,
+				lora::Bandwidth bandwidth,
+				lora::CodingRate coding_rate,
+				lora::HeaderMode header_mode,
+				lora::PayloadCRC crc
+				) {
+			_spreading_factor = spreading_factor;
+			_bandwidth = bandwidth;
+			_coding_rate = coding_rate;
+			_header_mode = header_mode;
+			_crc = crc;
+		}
+
+		/**
+		 * @brief Appends a message to the pending frame.
+		 *
+		 * @param now Current time; the deadline of the frame starts with its first message.
+		 *
+		 * @return False if the message does not fit in what is left of the frame (flush first) or is longer than
+		 *         aggregate::max_message.
+		 */
+		bool push(const uint8_t* message, uint8_t length, uint32_t now) {
+			if(length == 0 || length > aggregate::max_message || _length + 1 + length > aggregate::max_frame)
+				return false;
+
+			if(_count == 0)
+				_first = now;
+
+			_frame[_length++] = length;
+			std::memcpy(_frame + _length, message, length);
+			_length += length;
+			_count++;
+			return true;
+		}
+
+		/**
+		 * @brief Appends a message only if the frame keeps its airtime, i.e. it fits in the free bytes.
+		 */
+		bool push_if_free(const uint8_t* message, uint8_t length, uint32_t now) {
+			if(_count == 0 || 1 + length > free_bytes())
+				return false;
+			return push(message, length, now);
+		}
+
+		/** Bytes that can be added to the pending frame without adding symbols **/
+		uint8_t free_bytes() const {
+			if(_count == 0)
+				return 0;
+			return lora::symbol_aligned_length(_length, _spreading_factor, _bandwidth, _coding_rate, _header_mode, _crc)
+			       - _length;
+		}
+
+		/**
+		 * @brief True once the oldest message reached its deadline or no further record header and byte fit.
+		 */
+		bool should_flush(uint32_t now) const {
+			if(_count == 0)
+				return false;
+			return now - _first >= _max_delay || _length + 2 > aggregate::max_frame;
+		}
+
+		/**
+		 * @brief Returns the pending frame and starts a new one.
+		 *
+		 * @return The frame, empty if nothing was pending; valid until the next push().
+		 */
+		etl::span<const uint8_t> flush() {
+			if(_count == 0)
+				return {};
+
+			etl::span<const uint8_t> frame(_frame, _length);
+			clear();
+			return frame;
+		}
+
+		uint8_t pending_messages() const { return _count; }
+
+	private:
+		uint8_t _frame[aggregate::max_frame];
+		uint8_t _length = 1;
+		uint8_t _count = 0;
+		uint32_t _first = 0;
+		uint32_t _max_delay;
+
+		lora::SpreadingFactor _spreading_factor = lora::SpreadingFactor::SF_7;
+		lora::Bandwidth _bandwidth = lora::Bandwidth::BW_125_KHZ;
+		lora::CodingRate _coding_rate = lora::CodingRate::CR_4_5;
+		lora::HeaderMode _header_mode = lora::HeaderMode::EXPLICIT;
+		lora::PayloadCRC _crc = lora::PayloadCRC::ON;
+
+		void clear() {
+			_frame[0] = aggregate::kind;
+			_length = 1;
+			_count = 0;
+		}
+	};
+
+	/**
+	 * Receiving side: walks the messages of an aggregated frame, in place.
+	 * @code
+	 * Deaggregator messages(buffer, length);
+	 * while(auto message = messages.next()) {
+	 *     handle(*message);
+	 * }
+	 * @endcode
+	 */
+	class Deaggregator {
+	public:
+		Deaggregator(const uint8_t* frame, uint8_t length) : _frame(frame), _length(length) {
+			_valid = (length > 1 && frame[0] == aggregate::kind);
+			_position = 1;
+		};
+
+		/** Returns the next message, or nullopt at the end of the frame or on a record running past it **/
+		etl::optional<etl::span<const uint8_t>> next() {
+			if(!_valid || _position >= _length)
+				return etl::nullopt;
+
+			uint8_t length = _frame[_position];
+			if(length == 0 || _position + 1 + length > _length) {
+				_valid = false; /** truncated or corrupted **/
+				return etl::nullopt;
+			}
+
+			etl::span<const uint8_t> message(_frame + _position + 1, length);
+			_position += 1 + length;
+			return message;
+		}
+
+		/** False if the frame is not an aggregate or a record ran past its end **/
+		bool is_valid() const { return _valid; }
+
+	private:
+		const uint8_t* _frame;
+		uint8_t _length;
+		uint16_t _position;
+		bool _valid;
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_AGGREGATION_HPP
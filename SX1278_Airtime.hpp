@@ -0,0 +1,112 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_AIRTIME_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_AIRTIME_HPP
+
+#include <cstdint>
+
+#include "SX1278_ControlTable.hpp"
+
+namespace radio::sx1278::lora {
+	/**
+	 * LoRa time-on-air, following the "Time on air" section of the SX1276/77/78/79 datasheet.
+	 * Everything is constexpr, so frame times can be checked with static_assert or used to size schedules.
+	 */
+
+	/** LowDataRateOptimize is mandated when the symbol time exceeds 16 ms **/
+	constexpr bool low_data_rate_optimize(SpreadingFactor spreading_factor, Bandwidth bandwidth) {
+		return (1000UL << static_cast<uint8_t>(spreading_factor)) > 16 * bandwidth_hz(bandwidth);
+	}
+
+	/** Symbol time 2^SF / BW in microseconds **/
+	constexpr uint32_t symbol_time_us(SpreadingFactor spreading_factor, Bandwidth bandwidth) {
+		return static_cast<uint32_t>((1000000ULL << static_cast<uint8_t>(spreading_factor)) / bandwidth_hz(bandwidth));
+	}
+
+	/**
+	 * Number of payload symbols, including the 8 symbols always sent after the preamble:
+	 * 8 + max(ceil((8PL - 4SF + 28 + 16CRC - 20IH) / (4(SF - 2DE))) (CR + 4), 0)
+	 */
+	constexpr uint32_t payload_symbols(
+			uint8_t length,
+			SpreadingFactor spreading_factor,
+			CodingRate coding_rate,
+			HeaderMode header_mode,
+			PayloadCRC crc,
+			bool low_data_rate
+			) {
+		int32_t sf = static_cast<uint8_t>(spreading_factor);
+		int32_t bits = 8 * length - 4 * sf + 28
+				+ (crc == PayloadCRC::ON ? 16 : 0)
+				- (header_mode == HeaderMode::IMPLICIT ? 20 : 0);
+		int32_t bits_per_block = 4 * (sf - (low_data_rate ? 2 : 0));
+
+		if(bits <= 0)
+			return 8;
+
+		uint32_t blocks = static_cast<uint32_t>((bits + bits_per_block - 1) / bits_per_block);
+		return 8 + blocks * (static_cast<uint8_t>(coding_rate) + 4);
+	}
+
+	/** Time on air of a whole frame in microseconds: (preamble + 4.25 + payload symbols) * symbol time **/
+	constexpr uint32_t time_on_air_us(
+			uint8_t length,
+			SpreadingFactor spreading_factor,
+			Bandwidth bandwidth,
+			CodingRate coding_rate,
+			HeaderMode header_mode,
+			PayloadCRC crc,
+			uint16_t preamble_length,
+			bool low_data_rate
+			) {
+		uint64_t quarter_symbols = 4ULL * preamble_length + 17
+				+ 4ULL * payload_symbols(length, spreading_factor, coding_rate, header_mode, crc, low_data_rate);
+
+		return static_cast<uint32_t>((quarter_symbols * (1000000ULL << static_cast<uint8_t>(spreading_factor)))
+				/ (4ULL * bandwidth_hz(bandwidth)));
+	}
+
+	/** As above, with LowDataRateOptimize derived from SF and BW the same way SX1278 sets it **/
+	constexpr uint32_t time_on_air_us(
+			uint8_t length,
+			SpreadingFactor spreading_factor,
+			Bandwidth bandwidth,
+			CodingRate coding_rate,
+			HeaderMode header_mode,
+			PayloadCRC crc,
+			uint16_t preamble_length
+			) {
+		return time_on_air_us(length, spreading_factor, bandwidth, coding_rate, header_mode, crc, preamble_length,
+		                      low_data_rate_optimize(spreading_factor, bandwidth));
+	}
+
+	/**
+	 * Longest payload, from length up to 255 bytes, that still takes the same number of symbols as length: the bytes
+	 * between them fill the last interleaver block and are sent for free.
+	 */
+	constexpr uint8_t symbol_aligned_length(
+			uint8_t length,
+			SpreadingFactor spreading_factor,
+			Bandwidth bandwidth,
+			CodingRate coding_rate,
+			HeaderMode header_mode,
+			PayloadCRC crc
+			) {
+		bool low_data_rate = low_data_rate_optimize(spreading_factor, bandwidth);
+		uint32_t symbols = payload_symbols(length, spreading_factor, coding_rate, header_mode, crc, low_data_rate);
+
+		uint8_t aligned = length;
+		while(aligned < 255 &&
+		      payload_symbols(aligned + 1, spreading_factor, coding_rate, header_mode, crc, low_data_rate) == symbols) {
+			aligned++;
+		}
+		return aligned;
+	}
+
+	/** 125 kHz / 4:5, explicit header, CRC, 8 symbol preamble, 10 bytes: 41.216 ms at SF7, 991.232 ms at SF12 (LDRO) **/
+	static_assert(time_on_air_us(10, SpreadingFactor::SF_7, Bandwidth::BW_125_KHZ, CodingRate::CR_4_5,
+	                             HeaderMode::EXPLICIT, PayloadCRC::ON, 8) == 41216);
+	static_assert(time_on_air_us(10, SpreadingFactor::SF_12, Bandwidth::BW_125_KHZ, CodingRate::CR_4_5,
+	                             HeaderMode::EXPLICIT, PayloadCRC::ON, 8) == 991232);
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_AIRTIME_HPP
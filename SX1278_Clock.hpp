@@ -0,0 +1,90 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_CLOCK_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_CLOCK_HPP
+
+#include <cstdint>
+
+#if defined(__arm__)
+#include "main.h"
+#else
+#include <chrono>
+#endif
+
+namespace radio::sx1278 {
+	/**
+	 * Clocks used by the driver for profiling and timing. A clock has to provide:
+	 * - static uint32_t now() - free running tick counter, wrapping at 2^32,
+	 * - static uint32_t frequency() - ticks per second.
+	 * Any timer capture or RTOS tick source with that shape can be plugged in as the SX1278 Clock parameter.
+	 *
+	 * Tick differences are 32-bit, so every interval the driver measures or predicts (bus time, time on air, the
+	 * expected TxDone) has to stay below 2^32 ticks: 71 minutes for a 1 MHz clock, but only 8.9 s for DwtClock at
+	 * 480 MHz, less than one long frame at SF12 / 7.8 kHz. Pick the clock accordingly.
+	 */
+
+#if defined(__arm__)
+	/**
+	 * Core cycle counter (DWT->CYCCNT) of Cortex-M3 and above; call enable() once at start-up.
+	 *
+	 * @note Cortex-M0/M0+ have no cycle counter; use a timer-based clock there.
+	 * @note CYCCNT wraps after 2^32 / SystemCoreClock seconds (8.9 s at 480 MHz, 59.6 s at 72 MHz); with modem
+	 *       settings whose frames take longer, use a 1 MHz timer clock for event times and get_tx_done_time().
+	 */
+	struct DwtClock {
+		static void enable() {
+			CoreDebug->DEMCR = CoreDebug->DEMCR | CoreDebug_DEMCR_TRCENA_Msk;
+			DWT->CYCCNT = 0;
+			DWT->CTRL = DWT->CTRL | DWT_CTRL_CYCCNTENA_Msk;
+		}
+
+		static uint32_t now() {
+			return DWT->CYCCNT;
+		}
+
+		static uint32_t frequency() {
+			return SystemCoreClock;
+		}
+	};
+#else
+	/** Host monotonic clock with microsecond ticks, wrapping after 71 minutes like a 1 MHz timer on target **/
+	struct SteadyClock {
+		static uint32_t now() {
+			auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+			return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(since_epoch).count());
+		}
+
+		static uint32_t frequency() {
+			return 1000000UL;
+		}
+	};
+#endif
+
+	/** When a DIO0 event (RxDone / TxDone) happened, in ticks of the driver's Clock **/
+	struct EventTime {
+		/** DIO0 edge: the IRQ entry, or the timer capture passed to SX1278::on_dio0_irq(uint32_t) **/
+		uint32_t done;
+		/** end of the preamble (after the 4.25 sync symbols), back-computed from done and the symbols after it **/
+		uint32_t preamble_end;
+	};
+
+	/** Converts a tick difference of Clock to microseconds; the product is formed in 64 bits, so any 32-bit difference converts **/
+	template <typename Clock>
+	uint32_t ticks_to_us(uint32_t ticks) {
+		uint64_t us = (static_cast<uint64_t>(ticks) * 1000000ULL) / Clock::frequency();
+		return static_cast<uint32_t>(us);
+	}
+
+	/**
+	 * Converts microseconds to a tick difference of Clock, with the product formed in 64 bits.
+	 *
+	 * @note The result is exact as long as it fits the clock's 2^32 tick range (see above); beyond that it wraps like
+	 *       the counter itself, so it is only meaningful modulo 2^32.
+	 */
+	template <typename Clock>
+	uint32_t us_to_ticks(uint32_t us) {
+		uint64_t ticks = (static_cast<uint64_t>(us) * Clock::frequency()) / 1000000ULL;
+		return static_cast<uint32_t>(ticks);
+	}
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_CLOCK_HPP
@@ -0,0 +1,261 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_COMPRESSION_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_COMPRESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <etl/optional.h>
+#include <etl/span.h>
+
+namespace radio::sx1278::compression {
+	/**
+	 * Allocation-free LZSS for single frames, with an optional dictionary shared by both ends (e.g. one per message
+	 * type, holding a typical frame), so even short frames find matches.
+	 *
+	 * Format:
+	 * - [0x00] [payload...] - stored, used whenever compression does not pay off (worst case: length + 1 bytes),
+	 * - [0x01] [original length] [tokens...] - compressed. Tokens come in groups of up to 8 behind a flag byte,
+	 *   LSB first; flag 0 is a literal byte, flag 1 a match of 2 bytes: [offset[11:8] << 4 | (length - 3)] [offset[7:0]],
+	 *   copying 3..18 bytes from 1..4095 bytes back in dictionary + output.
+	 *
+	 * Bounds: the compressor keeps two 256-entry hash tables (1 KiB, inside the Compressor): the dictionary's, built
+	 * once in the constructor, is copied into the working one at the start of every frame. It probes a single
+	 * candidate per position, so it runs at most max_match byte compares per input byte plus a 512-byte copy.
+	 * The decompressor is a single pass without any table.
+	 */
+	static constexpr uint8_t stored = 0x00;
+	static constexpr uint8_t lzss = 0x01;
+
+	static constexpr uint8_t min_match = 3;
+	static constexpr uint8_t max_match = min_match + 15;
+	static constexpr uint16_t max_offset = 0x0FFF;
+	/** stored frames have a 1-byte header and have to fit a 255-byte frame **/
+	static constexpr uint8_t max_input = 254;
+	/** buffer size decompress_in_place() needs for any frame: the largest original plus one flag byte per 8 tokens **/
+	static constexpr std::size_t in_place_capacity = max_input + 255 / 8 + 1;
+
+	class Compressor {
+	public:
+		/**
+		 * @param dictionary Data matches may refer to besides the frame itself; must stay valid while the Compressor
+		 *        is used, and the receiver has to decompress with the same bytes. Only the last 4095 bytes are used.
+		 */
+		explicit Compressor(etl::span<const uint8_t> dictionary = {}) {
+			if(dictionary.size() > max_offset)
+				dictionary = dictionary.last(max_offset);
+			_dictionary = dictionary;
+
+			/** positions are counted in dictionary + input, the dictionary part of the table is the same for every frame **/
+			std::memset(_dictionary_table, 0xFF, sizeof(_dictionary_table));
+			auto dictionary_length = static_cast<uint16_t>(_dictionary.size());
+			for(uint16_t position = 0; position + min_match <= dictionary_length; position++) {
+				_dictionary_table[hash(position, nullptr)] = position;
+			}
+		};
+
+		/**
+		 * @brief Compresses one frame.
+		 *
+		 * @param in Frame to compress, at most max_input bytes.
+		 * @param length Its length.
+		 * @param out Output buffer of at least length + 1 bytes.
+		 *
+		 * @return Length of the output, never more than length + 1; 0 if the input is longer than max_input.
+		 */
+		uint8_t compress(const uint8_t* in, uint8_t length, uint8_t* out) {
+			if(length > max_input)
+				return 0;
+			if(length <= min_match)
+				return store(in, length, out);
+
+			std::memcpy(_table, _dictionary_table, sizeof(_table));
+
+			auto dictionary_length = static_cast<uint16_t>(_dictionary.size());
+			uint16_t end = dictionary_length + length;
+
+			uint16_t written = 2;
+			uint16_t flag_at = 0;
+			uint8_t flag_bit = 8;
+
+			uint16_t position = dictionary_length;
+			while(position < end) {
+				if(flag_bit == 8) {
+					if(written >= length)
+						return store(in, length, out); /** no gain, stop early **/
+					flag_at = written++;
+					out[flag_at] = 0;
+					flag_bit = 0;
+				}
+
+				uint16_t match_length = 0;
+				uint16_t match_offset = 0;
+				if(position + min_match <= end) {
+					uint8_t key = hash(position, in);
+					uint16_t candidate = _table[key];
+					_table[key] = position;
+
+					if(candidate != empty && position - candidate <= max_offset) {
+						uint16_t limit = end - position;
+						if(limit > max_match)
+							limit = max_match;
+						while(match_length < limit && at(candidate + match_length, in) == at(position + match_length, in)) {
+							match_length++;
+						}
+						match_offset = position - candidate;
+					}
+				}
+
+				if(match_length >= min_match) {
+					if(written + 2 > length)
+						return store(in, length, out);
+					out[flag_at] |= 1 << flag_bit;
+					out[written++] = static_cast<uint8_t>(((match_offset >> 8) << 4) | (match_length - min_match));
+					out[written++] = static_cast<uint8_t>(match_offset);
+					position += match_length;
+				} else {
+					if(written + 1 > length)
+						return store(in, length, out);
+					out[written++] = at(position, in);
+					position++;
+				}
+				flag_bit++;
+			}
+
+			out[0] = lzss;
+			out[1] = length;
+			return static_cast<uint8_t>(written);
+		}
+
+	private:
+		static constexpr uint16_t empty = 0xFFFF;
+
+		etl::span<const uint8_t> _dictionary{};
+		uint16_t _dictionary_table[256];
+		uint16_t _table[256];
+
+		uint8_t at(uint16_t position, const uint8_t* in) const {
+			auto dictionary_length = static_cast<uint16_t>(_dictionary.size());
+			return (position < dictionary_length) ? _dictionary[position] : in[position - dictionary_length];
+		}
+
+		uint8_t hash(uint16_t position, const uint8_t* in) const {
+			uint32_t value = (at(position, in) << 16) | (at(position + 1, in) << 8) | at(position + 2, in);
+			return static_cast<uint8_t>((value * 2654435761UL) >> 24);
+		}
+
+		static uint8_t store(const uint8_t* in, uint8_t length, uint8_t* out) {
+			out[0] = stored;
+			std::memmove(out + 1, in, length);
+			return static_cast<uint8_t>(length + 1);
+		}
+	};
+
+	/**
+	 * @brief Decompresses a frame produced by Compressor::compress().
+	 *
+	 * @param in Compressed frame.
+	 * @param length Its length.
+	 * @param out Output buffer; it may only overlap the input the way decompress_in_place() arranges it.
+	 * @param capacity Size of the output buffer.
+	 * @param dictionary The dictionary the frame was compressed with.
+	 *
+	 * @return Length of the decompressed frame, or nullopt if the frame is malformed or does not fit.
+	 */
+	inline etl::optional<uint8_t> decompress(const uint8_t* in, uint8_t length, uint8_t* out, std::size_t capacity,
+	                                         etl::span<const uint8_t> dictionary = {}) {
+		if(length == 0)
+			return etl::nullopt;
+
+		if(in[0] == stored) {
+			if(static_cast<std::size_t>(length - 1) > capacity)
+				return etl::nullopt;
+			std::memmove(out, in + 1, length - 1);
+			return static_cast<uint8_t>(length - 1);
+		}
+
+		if(in[0] != lzss || length < 2 || in[1] > capacity)
+			return etl::nullopt;
+
+		if(dictionary.size() > max_offset)
+			dictionary = dictionary.last(max_offset);
+		auto dictionary_length = static_cast<uint16_t>(dictionary.size());
+
+		uint8_t original = in[1];
+		uint16_t read = 2;
+		uint16_t written = 0;
+		uint8_t flags = 0;
+		uint8_t flag_bit = 8;
+
+		while(written < original) {
+			if(flag_bit == 8) {
+				if(read >= length)
+					return etl::nullopt;
+				flags = in[read++];
+				flag_bit = 0;
+			}
+
+			if(flags & (1 << flag_bit)) {
+				if(read + 2 > length)
+					return etl::nullopt;
+				uint8_t high = in[read++];
+				uint16_t offset = static_cast<uint16_t>(((high >> 4) << 8) | in[read++]);
+				uint16_t match_length = (high & 0x0F) + min_match;
+
+				if(offset == 0 || offset > dictionary_length + written || written + match_length > original)
+					return etl::nullopt;
+
+				/** source counted in dictionary + output, byte by byte as matches may overlap their own output **/
+				uint16_t source = dictionary_length + written - offset;
+				for(uint16_t i = 0; i < match_length; i++, source++) {
+					out[written++] = (source < dictionary_length) ? dictionary[source] : out[source - dictionary_length];
+				}
+			} else {
+				if(read >= length)
+					return etl::nullopt;
+				out[written++] = in[read++];
+			}
+			flag_bit++;
+		}
+
+		return static_cast<uint8_t>(written);
+	}
+
+	/**
+	 * @brief Decompresses a received frame in the buffer it was received into, e.g. right after getReceivedData().
+	 *
+	 * The compressed bytes are moved to the end of the buffer and decoded towards the front; every flag byte is the
+	 * only place where the decoder consumes more than it writes, so the output can never catch up with the input if
+	 * the buffer has room for the original frame plus length / 8 + 1 bytes.
+	 *
+	 * @note That is more than a 255-byte receive buffer (or FrameBuffer) holds for large frames: a 254-byte original
+	 *       compressed to 200 bytes needs 280. Size the buffer in_place_capacity (286 bytes) to take any frame, or
+	 *       decompress() into a second buffer.
+	 *
+	 * @param buffer Buffer holding the compressed frame at its start.
+	 * @param length Length of the compressed frame.
+	 * @param capacity Size of the buffer.
+	 * @param dictionary The dictionary the frame was compressed with.
+	 *
+	 * @return Length of the decompressed frame, now at the start of the buffer, or nullopt if the frame is malformed
+	 *         or the buffer is too small.
+	 */
+	inline etl::optional<uint8_t> decompress_in_place(uint8_t* buffer, uint8_t length, std::size_t capacity,
+	                                                  etl::span<const uint8_t> dictionary = {}) {
+		if(length == 0 || length > capacity)
+			return etl::nullopt;
+
+		if(buffer[0] == stored)
+			return decompress(buffer, length, buffer, capacity, dictionary);
+
+		if(length < 2 || static_cast<std::size_t>(buffer[1]) + length / 8 + 1 > capacity)
+			return etl::nullopt;
+
+		uint8_t* in = buffer + capacity - length;
+		std::memmove(in, buffer, length);
+		return decompress(in, length, buffer, capacity, dictionary);
+	}
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_COMPRESSION_HPP
@@ -6,6 +6,8 @@
 #ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_CONTROLTABLE_H
 #define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_CONTROLTABLE_H
 
+#include <cstdint>
+
 namespace radio::sx1278 {
 
 	enum class Status {
@@ -121,6 +123,36 @@ namespace radio::sx1278 {
 			BW_500_KHZ = 0b1001,
 		};
 
+		/** Bandwidth in Hz, as listed in the RegModemConfig1 description **/
+		constexpr uint32_t bandwidth_hz(Bandwidth bandwidth) {
+			constexpr uint32_t table[] = {7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000};
+			return table[static_cast<uint8_t>(bandwidth)];
+		}
+
+		/** RSSI offset of the RF port in use: HF (band 1, above 525 MHz) -157 dB, LF (bands 2 and 3) -164 dB **/
+		constexpr int16_t rssi_offset(uint32_t frequency_mhz) {
+			return (frequency_mhz > 525) ? -157 : -164;
+		}
+
+		/**
+		 * Packet strength in dBm from RegPktRssiValue and RegPktSnrValue (signed, 0.25 dB steps), per the datasheet:
+		 * offset + 16/15 * PacketRssi with SNR >= 0, offset + PacketRssi + SNR below the noise floor.
+		 */
+		constexpr int16_t packet_rssi(uint8_t pkt_rssi, int8_t pkt_snr, uint32_t frequency_mhz) {
+			if(pkt_snr < 0) {
+				return static_cast<int16_t>(rssi_offset(frequency_mhz) + pkt_rssi + pkt_snr / 4);
+			}
+			return static_cast<int16_t>(rssi_offset(frequency_mhz) + (pkt_rssi * 16) / 15);
+		}
+
+		/** SNR and strength of the last received packet **/
+		struct PacketStatus {
+			/** dBm **/
+			int16_t rssi;
+			/** 0.25 dB steps **/
+			int8_t snr;
+		};
+
 		enum class CodingRate : uint8_t {
 			CR_4_5 = 0b001,
 			CR_4_6 = 0b010,
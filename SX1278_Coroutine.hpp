@@ -0,0 +1,132 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_COROUTINE_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_COROUTINE_HPP
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+#include <etl/optional.h>
+#include <etl/span.h>
+
+#ifndef SX1278_CORO_FRAME_SIZE
+#define SX1278_CORO_FRAME_SIZE 256
+#endif
+
+#ifndef SX1278_CORO_FRAME_COUNT
+#define SX1278_CORO_FRAME_COUNT 4
+#endif
+
+namespace radio::sx1278 {
+	/**
+	 * Static storage for coroutine frames, so Task coroutines never touch the heap.
+	 *
+	 * Frame size and count are set with SX1278_CORO_FRAME_SIZE / SX1278_CORO_FRAME_COUNT. A coroutine whose frame
+	 * does not fit, or started while all frames are in use, is not created (see Task::operator bool).
+	 */
+	class CoroutineFramePool {
+	public:
+		static constexpr std::size_t frame_size = SX1278_CORO_FRAME_SIZE;
+		static constexpr std::size_t frame_count = SX1278_CORO_FRAME_COUNT;
+
+		static void* allocate(std::size_t size) noexcept {
+			if(size > frame_size)
+				return nullptr;
+
+			for(std::size_t i = 0; i < frame_count; i++) {
+				if(!used[i].test_and_set(std::memory_order_acquire))
+					return storage[i].bytes;
+			}
+			return nullptr;
+		}
+
+		/** Safe from interrupt context; frames are released when a coroutine finishes, which may happen in an IRQ **/
+		static void release(void* ptr) noexcept {
+			for(std::size_t i = 0; i < frame_count; i++) {
+				if(ptr == storage[i].bytes) {
+					used[i].clear(std::memory_order_release);
+					return;
+				}
+			}
+		}
+
+	private:
+		struct alignas(std::max_align_t) Frame {
+			uint8_t bytes[frame_size];
+		};
+
+		static inline Frame storage[frame_count];
+		static inline std::atomic_flag used[frame_count];
+	};
+
+	/**
+	 * Fire-and-forget coroutine type for MAC logic driven by SX1278 awaitables.
+	 *
+	 * The coroutine starts running immediately and its frame is returned to CoroutineFramePool when it finishes.
+	 *
+	 * @note Awaitables are resumed from on_dio0_irq() / on_spi_complete(), so code after a co_await runs in
+	 *       interrupt context until the next suspension point.
+	 */
+	class Task {
+	public:
+		struct promise_type {
+			Task get_return_object() noexcept { return Task{true}; }
+			static Task get_return_object_on_allocation_failure() noexcept { return Task{false}; }
+
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept {}
+
+			static void* operator new(std::size_t size) noexcept { return CoroutineFramePool::allocate(size); }
+			static void operator delete(void* ptr) noexcept { CoroutineFramePool::release(ptr); }
+		};
+
+		/** False if no frame was available and the coroutine never started **/
+		explicit operator bool() const { return _started; }
+
+	private:
+		explicit Task(bool started) : _started(started) {};
+		bool _started;
+	};
+
+	/** co_await radio.transmit(data) - resumes on TxDone with true, or immediately with false if it could not start **/
+	template <typename Radio>
+	struct TransmitAwaiter {
+		Radio& radio;
+		etl::span<const uint8_t> data;
+
+		bool await_ready() const noexcept { return false; }
+		bool await_suspend(std::coroutine_handle<> handle) { return radio.coro_start_transmit(handle, data); }
+		bool await_resume() const noexcept { return radio._coro_result; }
+	};
+
+	/** co_await radio.receive(buffer, deadline) - resumes with the packet length, or nullopt once on_tick() passes the deadline **/
+	template <typename Radio>
+	struct ReceiveAwaiter {
+		Radio& radio;
+		etl::span<uint8_t> buffer;
+		uint32_t deadline;
+
+		bool await_ready() const noexcept { return false; }
+		bool await_suspend(std::coroutine_handle<> handle) { return radio.coro_start_receive(handle, buffer, deadline); }
+		etl::optional<uint8_t> await_resume() const noexcept {
+			if(!radio._coro_result)
+				return etl::nullopt;
+			return radio._coro_rx_length;
+		}
+	};
+
+	/** co_await radio.cad() - resumes on CadDone with true if activity was detected **/
+	template <typename Radio>
+	struct CadAwaiter {
+		Radio& radio;
+
+		bool await_ready() const noexcept { return false; }
+		bool await_suspend(std::coroutine_handle<> handle) { return radio.coro_start_cad(handle); }
+		bool await_resume() const noexcept { return radio._coro_result; }
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_COROUTINE_HPP
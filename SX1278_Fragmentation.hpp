@@ -0,0 +1,428 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_FRAGMENTATION_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_FRAGMENTATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <etl/optional.h>
+#include <etl/span.h>
+
+namespace radio::sx1278 {
+	/**
+	 * Fragmentation of messages larger than one LoRa frame, with selective re-requests.
+	 *
+	 * Frame formats (first byte tells fragment frames apart from the application's own frames):
+	 * - DATA:    [0xF1] [message id] [fragment index] [fragment count - 1] [payload...]
+	 * - NACK:    [0xF2] [message id] [fragment count - 1] [bitmap of missing fragments, (count + 7) / 8 bytes]
+	 *            an all-zero bitmap acknowledges the complete message.
+	 *
+	 * Every fragment but the last carries exactly FragmentPayload bytes, so both ends have to use the same value.
+	 * A message has at most 256 fragments (64256 bytes with the default payload). Messages are told apart by their
+	 * 8-bit id only, there is no addressing.
+	 */
+	namespace fragment {
+		static constexpr uint8_t data = 0xF1;
+		static constexpr uint8_t nack = 0xF2;
+
+		static constexpr uint8_t data_header_size = 4;
+		static constexpr uint8_t nack_header_size = 3;
+		static constexpr uint16_t max_fragments = 256;
+		/** largest NACK frame, with the bitmap of 256 fragments **/
+		static constexpr uint8_t max_nack_size = nack_header_size + max_fragments / 8;
+
+		/** Bitmap of fragment indexes **/
+		struct FragmentMask {
+			uint32_t words[max_fragments / 32] = {};
+
+			void set(uint8_t index) { words[index >> 5] |= 1UL << (index & 0x1F); }
+			void reset(uint8_t index) { words[index >> 5] &= ~(1UL << (index & 0x1F)); }
+			bool test(uint8_t index) const { return words[index >> 5] & (1UL << (index & 0x1F)); }
+			void clear() { std::memset(words, 0, sizeof(words)); }
+
+			/** Sets bits 0 .. count - 1 **/
+			void fill(uint16_t count) {
+				clear();
+				for(uint16_t i = 0; i < count; i++) {
+					set(static_cast<uint8_t>(i));
+				}
+			}
+		};
+	}
+
+	/**
+	 * Sending side: splits a message into DATA frames and re-sends only what the receiver reports missing.
+	 *
+	 * Fragments are returned as a header and a payload span into the message, ready for the gather
+	 * SX1278::startTransmit(), so the message is never copied:
+	 * @code
+	 * while(auto fragment = fragmenter.next()) {
+	 *     radio.startTransmit(fragment->parts);
+	 *     ... wait for TxDone ...
+	 * }
+	 * @endcode
+	 *
+	 * @tparam FragmentPayload Payload bytes per fragment, at most 251 so a fragment fits a 255-byte frame.
+	 */
+	template <uint8_t FragmentPayload = 251>
+	class Fragmenter {
+		static_assert(FragmentPayload > 0 && FragmentPayload <= 255 - fragment::data_header_size,
+		              "A fragment has to fit in one frame");
+
+	public:
+		struct Fragment {
+			/** header and payload, in order **/
+			etl::span<const uint8_t> parts[2];
+		};
+
+		/**
+		 * @brief Starts sending a message; all fragments become pending.
+		 *
+		 * @param message Message to send; must stay valid until it is complete or another one is started.
+		 * @param id Message id, should differ from the previous message's id.
+		 *
+		 * @return False if the message is empty or needs more than 256 fragments.
+		 */
+		bool start(etl::span<const uint8_t> message, uint8_t id) {
+			std::size_t count = (message.size() + FragmentPayload - 1) / FragmentPayload;
+			if(count == 0 || count > fragment::max_fragments)
+				return false;
+
+			_message = message;
+			_id = id;
+			_count = static_cast<uint16_t>(count);
+			_pending.fill(_count);
+			_next = 0;
+			_acknowledged = false;
+			return true;
+		}
+
+		/**
+		 * @brief Returns the next pending fragment, or nullopt when nothing is pending.
+		 *
+		 * @note The header part points into the Fragmenter and is only valid until the next call.
+		 */
+		etl::optional<Fragment> next() {
+			for(uint16_t i = 0; i < _count; i++) {
+				auto index = static_cast<uint8_t>((_next + i) % _count);
+				if(!_pending.test(index))
+					continue;
+
+				_pending.reset(index);
+				_next = static_cast<uint16_t>(index + 1);
+
+				std::size_t offset = static_cast<std::size_t>(index) * FragmentPayload;
+				std::size_t length = _message.size() - offset;
+				if(length > FragmentPayload)
+					length = FragmentPayload;
+
+				_header[0] = fragment::data;
+				_header[1] = _id;
+				_header[2] = index;
+				_header[3] = static_cast<uint8_t>(_count - 1);
+
+				Fragment result;
+				result.parts[0] = etl::span<const uint8_t>(_header, fragment::data_header_size);
+				result.parts[1] = _message.subspan(offset, length);
+				return result;
+			}
+			return etl::nullopt;
+		}
+
+		/**
+		 * @brief Handles a NACK frame: missing fragments become pending again, an empty bitmap completes the message.
+		 *
+		 * @return True if the frame was a NACK for the current message.
+		 */
+		bool on_frame(const uint8_t* frame, uint8_t length) {
+			if(length < fragment::nack_header_size || frame[0] != fragment::nack || frame[1] != _id ||
+			   frame[2] != static_cast<uint8_t>(_count - 1) || _count == 0)
+				return false;
+
+			uint8_t bitmap_length = static_cast<uint8_t>((_count + 7) / 8);
+			if(length < fragment::nack_header_size + bitmap_length)
+				return false;
+
+			const uint8_t* bitmap = frame + fragment::nack_header_size;
+			bool missing = false;
+			for(uint16_t i = 0; i < _count; i++) {
+				if(bitmap[i >> 3] & (1 << (i & 0x07))) {
+					_pending.set(static_cast<uint8_t>(i));
+					missing = true;
+				}
+			}
+
+			if(!missing)
+				_acknowledged = true;
+			return true;
+		}
+
+		/** True while fragments are waiting to be (re)sent **/
+		bool has_pending() const {
+			for(auto word : _pending.words) {
+				if(word != 0)
+					return true;
+			}
+			return false;
+		}
+
+		/** True once the receiver acknowledged the whole message **/
+		bool is_complete() const { return _acknowledged; }
+
+		uint16_t fragment_count() const { return _count; }
+
+	private:
+		etl::span<const uint8_t> _message{};
+		uint8_t _id = 0;
+		uint16_t _count = 0;
+		uint16_t _next = 0;
+		bool _acknowledged = false;
+		fragment::FragmentMask _pending;
+		uint8_t _header[fragment::data_header_size]{};
+	};
+
+	/**
+	 * Receiving side: reassembles DATA frames into caller-provided memory and builds NACK / ACK frames.
+	 *
+	 * The memory is split evenly between MaxMessages table entries, so each entry takes messages up to
+	 * memory.size() / MaxMessages bytes. Fragments may arrive in any order and more than once. A missing fragment is
+	 * re-requested as soon as the last fragment arrives, and from poll() once an entry has been silent for the
+	 * timeout; an entry is dropped after max_retries NACKs without progress.
+	 *
+	 * Nothing is sent by the Reassembler itself: control frames are fetched with next_control() and handed to the
+	 * radio by the caller.
+	 *
+	 * @tparam MaxMessages Number of messages assembled at the same time.
+	 * @tparam FragmentPayload Payload bytes per fragment, the same as on the sending side.
+	 */
+	template <uint8_t MaxMessages, uint8_t FragmentPayload = 251>
+	class Reassembler {
+		static_assert(MaxMessages > 0, "At least one message has to be assembled");
+		static_assert(FragmentPayload > 0 && FragmentPayload <= 255 - fragment::data_header_size,
+		              "A fragment has to fit in one frame");
+
+	public:
+		struct Message {
+			uint8_t id;
+			etl::span<uint8_t> data;
+		};
+
+		/** Frames dropped, by reason **/
+		struct Stats {
+			uint32_t no_free_entry;
+			uint32_t too_large;
+			uint32_t malformed;
+			uint32_t timed_out;
+		};
+
+		/**
+		 * @param memory Reassembly memory, split evenly between the table entries.
+		 * @param timeout Silence after which missing fragments are re-requested, in the time base of poll().
+		 * @param max_retries NACKs sent without progress before a message is dropped.
+		 */
+		Reassembler(etl::span<uint8_t> memory, uint32_t timeout, uint8_t max_retries) :
+			_capacity(memory.size() / MaxMessages), _timeout(timeout), _max_retries(max_retries) {
+			for(uint8_t i = 0; i < MaxMessages; i++) {
+				_entries[i].buffer = memory.data() + i * _capacity;
+			}
+		};
+
+		/**
+		 * @brief Handles a received DATA frame.
+		 *
+		 * @param frame The received frame.
+		 * @param length Its length.
+		 * @param now Current time, in the same units as the timeout.
+		 *
+		 * @return The message once its last missing fragment arrived. Its data stays valid until release() is called
+		 *         with its id; until then duplicates are answered with an ACK.
+		 */
+		etl::optional<Message> on_frame(const uint8_t* frame, uint8_t length, uint32_t now) {
+			if(length <= fragment::data_header_size || frame[0] != fragment::data) {
+				_stats.malformed++;
+				return etl::nullopt;
+			}
+
+			uint8_t id = frame[1];
+			uint8_t index = frame[2];
+			uint16_t count = static_cast<uint16_t>(frame[3]) + 1;
+			auto payload_length = static_cast<uint8_t>(length - fragment::data_header_size);
+			bool last = (index == count - 1);
+
+			if(index >= count || (!last && payload_length != FragmentPayload) || payload_length > FragmentPayload) {
+				_stats.malformed++;
+				return etl::nullopt;
+			}
+
+			Entry* entry = find(id);
+			if(entry != nullptr && entry->count != count) {
+				_stats.malformed++;
+				return etl::nullopt;
+			}
+
+			if(entry != nullptr && entry->state == State::COMPLETE) {
+				entry->control_pending = true; /** the sender missed our ACK **/
+				return etl::nullopt;
+			}
+
+			if(entry == nullptr) {
+				entry = allocate(id, count, now);
+				if(entry == nullptr) {
+					_stats.no_free_entry++;
+					return etl::nullopt;
+				}
+			}
+
+			std::size_t offset = static_cast<std::size_t>(index) * FragmentPayload;
+			if(offset + payload_length > _capacity) {
+				entry->state = State::FREE;
+				_stats.too_large++;
+				return etl::nullopt;
+			}
+
+			if(!entry->received.test(index)) {
+				std::memcpy(entry->buffer + offset, frame + fragment::data_header_size, payload_length);
+				entry->received.set(index);
+				entry->received_count++;
+				entry->retries = 0;
+			}
+			entry->last_activity = now;
+			if(last)
+				entry->length = offset + payload_length;
+
+			if(entry->received_count == entry->count) {
+				entry->state = State::COMPLETE;
+				entry->control_pending = true; /** ACK **/
+				return Message{id, etl::span<uint8_t>(entry->buffer, entry->length)};
+			}
+
+			if(last)
+				entry->control_pending = true; /** the sender is through its list, ask for the gaps now **/
+			return etl::nullopt;
+		}
+
+		/**
+		 * @brief Re-requests missing fragments of silent messages and drops those that ran out of retries.
+		 *
+		 * @param now Current time, in the same units as the timeout.
+		 */
+		void poll(uint32_t now) {
+			for(auto& entry : _entries) {
+				if(entry.state != State::ASSEMBLING || now - entry.last_activity < _timeout)
+					continue;
+
+				if(entry.retries >= _max_retries) {
+					entry.state = State::FREE;
+					_stats.timed_out++;
+					continue;
+				}
+
+				entry.retries++;
+				entry.last_activity = now;
+				entry.control_pending = true;
+			}
+		}
+
+		/**
+		 * @brief Builds the next pending NACK (or ACK for a complete message).
+		 *
+		 * @param frame Output buffer of at least fragment::max_nack_size bytes.
+		 *
+		 * @return Length of the frame, 0 if nothing has to be sent.
+		 */
+		uint8_t next_control(uint8_t* frame) {
+			for(auto& entry : _entries) {
+				if(entry.state == State::FREE || !entry.control_pending)
+					continue;
+
+				entry.control_pending = false;
+
+				uint8_t bitmap_length = static_cast<uint8_t>((entry.count + 7) / 8);
+				frame[0] = fragment::nack;
+				frame[1] = entry.id;
+				frame[2] = static_cast<uint8_t>(entry.count - 1);
+
+				uint8_t* bitmap = frame + fragment::nack_header_size;
+				std::memset(bitmap, 0, bitmap_length);
+				if(entry.state == State::ASSEMBLING) {
+					for(uint16_t i = 0; i < entry.count; i++) {
+						if(!entry.received.test(static_cast<uint8_t>(i)))
+							bitmap[i >> 3] |= 1 << (i & 0x07);
+					}
+				}
+				return fragment::nack_header_size + bitmap_length;
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief Frees the entry of a complete message once the caller is done with its data.
+		 */
+		void release(uint8_t id) {
+			Entry* entry = find(id);
+			if(entry != nullptr && entry->state == State::COMPLETE)
+				entry->state = State::FREE;
+		}
+
+		/** Largest message one table entry can take **/
+		std::size_t capacity() const { return _capacity; }
+
+		const Stats& stats() const { return _stats; }
+
+	private:
+		enum class State : uint8_t {
+			FREE,
+			ASSEMBLING,
+			COMPLETE,
+		};
+
+		struct Entry {
+			State state = State::FREE;
+			bool control_pending = false;
+			uint8_t id = 0;
+			uint8_t retries = 0;
+			uint16_t count = 0;
+			uint16_t received_count = 0;
+			std::size_t length = 0;
+			uint32_t last_activity = 0;
+			fragment::FragmentMask received;
+			uint8_t* buffer = nullptr;
+		};
+
+		Entry _entries[MaxMessages];
+		std::size_t _capacity;
+		uint32_t _timeout;
+		uint8_t _max_retries;
+		Stats _stats{};
+
+		Entry* find(uint8_t id) {
+			for(auto& entry : _entries) {
+				if(entry.state != State::FREE && entry.id == id)
+					return &entry;
+			}
+			return nullptr;
+		}
+
+		Entry* allocate(uint8_t id, uint16_t count, uint32_t now) {
+			for(auto& entry : _entries) {
+				if(entry.state != State::FREE)
+					continue;
+
+				entry.state = State::ASSEMBLING;
+				entry.control_pending = false;
+				entry.id = id;
+				entry.retries = 0;
+				entry.count = count;
+				entry.received_count = 0;
+				entry.length = 0;
+				entry.last_activity = now;
+				entry.received.clear();
+				return &entry;
+			}
+			return nullptr;
+		}
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_FRAGMENTATION_HPP
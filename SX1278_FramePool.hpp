@@ -0,0 +1,178 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_FRAMEPOOL_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_FRAMEPOOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace radio::sx1278 {
+	/**
+	 * One LoRa frame: the largest payload plus its length, 288 bytes.
+	 *
+	 * The payload fills whole 32-byte cache lines and the length starts a line of its own, so the cache invalidate
+	 * after a DMA drain into data never discards it.
+	 */
+	struct alignas(32) FrameBuffer {
+		/** up to 255 bytes used, the last one pads to a line boundary **/
+		uint8_t data[256];
+		alignas(32) uint8_t length;
+	};
+	static_assert(offsetof(FrameBuffer, length) == 256 && sizeof(FrameBuffer) == 288,
+	              "FrameBuffer payload and length must sit on separate cache lines");
+
+	class FramePoolBase;
+
+	/**
+	 * Move-only owner of a pool buffer; the buffer goes back to its pool when the handle is destroyed or released.
+	 * Handles are passed along the stack instead of copying the payload.
+	 */
+	class FrameHandle {
+	public:
+		FrameHandle() = default;
+		FrameHandle(const FrameHandle&) = delete;
+		FrameHandle& operator=(const FrameHandle&) = delete;
+
+		FrameHandle(FrameHandle&& other) noexcept : _pool(other._pool), _buffer(other._buffer) {
+			other._pool = nullptr;
+			other._buffer = nullptr;
+		}
+
+		FrameHandle& operator=(FrameHandle&& other) noexcept {
+			if(this != &other) {
+				release();
+				_pool = other._pool;
+				_buffer = other._buffer;
+				other._pool = nullptr;
+				other._buffer = nullptr;
+			}
+			return *this;
+		}
+
+		~FrameHandle() { release(); }
+
+		/** Returns the buffer to its pool, the handle is empty afterwards **/
+		inline void release() noexcept;
+
+		explicit operator bool() const { return _buffer != nullptr; }
+		FrameBuffer* get() const { return _buffer; }
+		FrameBuffer* operator->() const { return _buffer; }
+		FrameBuffer& operator*() const { return *_buffer; }
+
+	private:
+		friend class FramePoolBase;
+
+		FrameHandle(FramePoolBase* pool, FrameBuffer* buffer) : _pool(pool), _buffer(buffer) {};
+
+		FramePoolBase* _pool = nullptr;
+		FrameBuffer* _buffer = nullptr;
+	};
+
+	/** Occupancy of a FramePool **/
+	struct FramePoolStats {
+		uint8_t capacity;
+		uint8_t in_use;
+		/** highest in_use seen **/
+		uint8_t peak;
+		/** allocate() calls that found the pool empty **/
+		uint32_t failures;
+	};
+
+	/**
+	 * Pool logic shared by all sizes, so handles do not depend on the pool size.
+	 *
+	 * Free buffers are bits of one atomic word: allocate() claims the lowest set bit with a compare-exchange and
+	 * release gives it back with fetch_or, so both are lock-free and can be called from interrupts as well as from
+	 * the main loop (on targets with exclusive load / store, Cortex-M3 and up).
+	 */
+	class FramePoolBase {
+	public:
+		FramePoolBase(const FramePoolBase&) = delete;
+		FramePoolBase& operator=(const FramePoolBase&) = delete;
+
+		/** Returns a free buffer with length 0, or an empty handle if all are in use **/
+		FrameHandle allocate() {
+			uint32_t mask = _free.load(std::memory_order_relaxed);
+			uint8_t index;
+			do {
+				if(mask == 0) {
+					_failures.fetch_add(1, std::memory_order_relaxed);
+					return {};
+				}
+				index = static_cast<uint8_t>(__builtin_ctz(mask));
+			} while(!_free.compare_exchange_weak(mask, mask & ~(1UL << index), std::memory_order_acquire,
+			                                     std::memory_order_relaxed));
+
+			/** record the high-water mark **/
+			auto in_use = static_cast<uint8_t>(_capacity - __builtin_popcount(mask) + 1);
+			uint8_t peak = _peak.load(std::memory_order_relaxed);
+			while(in_use > peak && !_peak.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {}
+
+			_buffers[index].length = 0;
+			return FrameHandle(this, &_buffers[index]);
+		}
+
+		FramePoolStats stats() const {
+			return {
+				_capacity,
+				static_cast<uint8_t>(_capacity - __builtin_popcount(_free.load(std::memory_order_relaxed))),
+				_peak.load(std::memory_order_relaxed),
+				_failures.load(std::memory_order_relaxed)
+			};
+		}
+
+	protected:
+		FramePoolBase(FrameBuffer* buffers, uint8_t capacity)
+			: _buffers(buffers), _capacity(capacity),
+			  _free((capacity == 32) ? 0xFFFFFFFFUL : (1UL << capacity) - 1) {};
+
+	private:
+		friend class FrameHandle;
+
+		void free(FrameBuffer* buffer) noexcept {
+			auto index = static_cast<uint8_t>(buffer - _buffers);
+			_free.fetch_or(1UL << index, std::memory_order_release);
+		}
+
+		FrameBuffer* _buffers;
+		uint8_t _capacity;
+		std::atomic<uint32_t> _free;
+		std::atomic<uint8_t> _peak{0};
+		std::atomic<uint32_t> _failures{0};
+	};
+
+	inline void FrameHandle::release() noexcept {
+		if(_buffer != nullptr) {
+			_pool->free(_buffer);
+			_pool = nullptr;
+			_buffer = nullptr;
+		}
+	}
+
+	/**
+	 * Static pool of frame buffers, no heap. Frames are received straight into a pool buffer
+	 * (SX1278::getReceivedFrame()) and queued for TX by handle (SX1278::queueTransmit(FrameHandle&&)),
+	 * so a payload is written once and never copied between layers.
+	 * @code
+	 * static FramePool<8> pool;
+	 * if(auto frame = radio.getReceivedFrame(pool)) {
+	 *     handle(frame->data, frame->length);
+	 * }
+	 * @endcode
+	 * With SX1278_SPI_DMA the frame is handed to SX1278::on_rx_frame once its drain has completed instead.
+	 *
+	 * @tparam Count Number of buffers, 1..32.
+	 */
+	template <uint8_t Count>
+	class FramePool : public FramePoolBase {
+		static_assert(Count > 0 && Count <= 32, "A pool holds 1 to 32 buffers");
+
+	public:
+		FramePool() : FramePoolBase(_storage, Count) {};
+
+	private:
+		FrameBuffer _storage[Count];
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_FRAMEPOOL_HPP
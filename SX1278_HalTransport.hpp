@@ -0,0 +1,139 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_HALTRANSPORT_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_HALTRANSPORT_HPP
+
+#include <cstdint>
+
+#include "main.h"
+#include "Utils/hw.hpp"
+#include "SX1278_Clock.hpp"
+
+namespace radio::sx1278 {
+	struct PinoutConfig {
+		/** Pointer to HAL SPI handle **/
+		SPI_HandleTypeDef* spi_handle;
+		/** NSS pin **/
+		utils::GPIO_Pin NSS;
+		/** RESET pin **/
+		utils::GPIO_Pin RESET;
+		/** DIO pins **/
+		utils::GPIO_Pin DIO0;
+		// utils::GPIO_Pin DIO1;
+		// utils::GPIO_Pin DIO2;
+		// utils::GPIO_Pin DIO3;
+		// utils::GPIO_Pin DIO4;
+		// utils::GPIO_Pin DIO5;
+	};
+
+	/**
+	 * SX1278 bus backend built on the STM32 HAL SPI and GPIO drivers.
+	 *
+	 * @note The non-blocking API needs the SPI global interrupt enabled, and SX1278::on_spi_complete() has to be
+	 *       called from HAL_SPI_TxCpltCallback, HAL_SPI_RxCpltCallback and HAL_SPI_TxRxCpltCallback.
+	 * @note With SX1278_SPI_DMA the SPI handle also needs TX and RX DMA channels configured.
+	 * @note On parts with a D-cache (F7/H7) DMA RX buffers should be 32-byte aligned and padded to a multiple
+	 *       of 32 bytes, since invalidation works on whole cache lines.
+	 */
+	class HalTransport {
+	public:
+		using clock = DwtClock;
+
+		explicit HalTransport(PinoutConfig pinout_config) : pinout_config(pinout_config) {};
+
+		void select() {
+			HAL_GPIO_WritePin(pinout_config.NSS.GPIOPort, pinout_config.NSS.GPIOPin, GPIO_PIN_RESET);
+		}
+
+		void deselect() {
+			HAL_GPIO_WritePin(pinout_config.NSS.GPIOPort, pinout_config.NSS.GPIOPin, GPIO_PIN_SET);
+		}
+
+		bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length) {
+			return HAL_SPI_TransmitReceive(pinout_config.spi_handle, const_cast<uint8_t*>(tx), rx, length, HAL_MAX_DELAY) == HAL_OK;
+		}
+
+		bool write(const uint8_t* data, uint16_t length) {
+			return HAL_SPI_Transmit(pinout_config.spi_handle, const_cast<uint8_t*>(data), length, HAL_MAX_DELAY) == HAL_OK;
+		}
+
+		bool read(uint8_t* data, uint16_t length) {
+			return HAL_SPI_Receive(pinout_config.spi_handle, data, length, HAL_MAX_DELAY) == HAL_OK;
+		}
+
+		void reset() {
+			HAL_GPIO_WritePin(pinout_config.RESET.GPIOPort, pinout_config.RESET.GPIOPin, GPIO_PIN_RESET);
+			HAL_Delay(1);
+			HAL_GPIO_WritePin(pinout_config.RESET.GPIOPort, pinout_config.RESET.GPIOPin, GPIO_PIN_SET);
+			HAL_Delay(10);
+		}
+
+		bool transfer_async(const uint8_t* tx, uint8_t* rx, uint16_t length) {
+			auto tx_data = const_cast<uint8_t*>(tx);
+
+			if(rx == nullptr) {
+				return HAL_SPI_Transmit_IT(pinout_config.spi_handle, tx_data, length) == HAL_OK;
+			} else if(tx == nullptr) {
+				return HAL_SPI_Receive_IT(pinout_config.spi_handle, rx, length) == HAL_OK;
+			}
+			return HAL_SPI_TransmitReceive_IT(pinout_config.spi_handle, tx_data, rx, length) == HAL_OK;
+		}
+
+		uint32_t critical_enter() {
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			return primask;
+		}
+
+		void critical_exit(uint32_t primask) {
+			__set_PRIMASK(primask);
+		}
+
+#ifdef SX1278_SPI_DMA
+		bool write_dma(const uint8_t* data, uint16_t length) {
+			dcache_clean(data, length);
+			return HAL_SPI_Transmit_DMA(pinout_config.spi_handle, const_cast<uint8_t*>(data), length) == HAL_OK;
+		}
+
+		bool read_dma(uint8_t* data, uint16_t length) {
+			dcache_invalidate(data, length);
+			return HAL_SPI_Receive_DMA(pinout_config.spi_handle, data, length) == HAL_OK;
+		}
+
+		void read_dma_complete(uint8_t* data, uint16_t length) {
+			dcache_invalidate(data, length); /** drop lines speculatively refilled while DMA was running **/
+		}
+#endif
+
+	private:
+		PinoutConfig pinout_config;
+
+#ifdef SX1278_SPI_DMA
+		/** Cortex-M7 D-cache maintenance works on whole 32-byte lines **/
+		static constexpr uintptr_t dcache_line = 32;
+
+		static void dcache_clean(const uint8_t* buffer, uint16_t length) {
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+			auto start = reinterpret_cast<uintptr_t>(buffer) & ~(dcache_line - 1);
+			auto end = reinterpret_cast<uintptr_t>(buffer) + length;
+			SCB_CleanDCache_by_Addr(reinterpret_cast<uint32_t*>(start), static_cast<int32_t>(end - start));
+#else
+			(void)buffer;
+			(void)length;
+#endif
+		}
+
+		static void dcache_invalidate(uint8_t* buffer, uint16_t length) {
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+			auto start = reinterpret_cast<uintptr_t>(buffer) & ~(dcache_line - 1);
+			auto end = reinterpret_cast<uintptr_t>(buffer) + length;
+			SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t*>(start), static_cast<int32_t>(end - start));
+#else
+			(void)buffer;
+			(void)length;
+#endif
+		}
+#endif
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_HALTRANSPORT_HPP
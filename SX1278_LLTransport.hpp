@@ -0,0 +1,105 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_LLTRANSPORT_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_LLTRANSPORT_HPP
+
+#include <cstdint>
+
+#include "main.h"
+#include "Utils/hw.hpp"
+#include "SX1278_Clock.hpp"
+
+namespace radio::sx1278 {
+	struct LLPinoutConfig {
+		/** SPI peripheral, configured as 8-bit master and enabled (LL_SPI_Enable) **/
+		SPI_TypeDef* spi;
+		/** NSS pin **/
+		utils::GPIO_Pin NSS;
+		/** RESET pin **/
+		utils::GPIO_Pin RESET;
+		/** DIO pins **/
+		utils::GPIO_Pin DIO0;
+	};
+
+	/**
+	 * SX1278 bus backend driving the SPI data register directly through the STM32 LL drivers.
+	 *
+	 * Every byte is exchanged by polling TXE/RXNE, which skips the HAL handle locking and state bookkeeping
+	 * and keeps a register access down to a few dozen instructions.
+	 *
+	 * @note Does not provide DMA; with SX1278_SPI_DMA the driver falls back to blocking bursts.
+	 */
+	class LLTransport {
+	public:
+		using clock = DwtClock;
+
+		explicit LLTransport(LLPinoutConfig pinout_config) : pinout_config(pinout_config) {};
+
+		void select() {
+			pinout_config.NSS.GPIOPort->BSRR = static_cast<uint32_t>(pinout_config.NSS.GPIOPin) << 16;
+		}
+
+		void deselect() {
+			while(LL_SPI_IsActiveFlag_BSY(pinout_config.spi)); /** last bit has to leave the shifter **/
+			pinout_config.NSS.GPIOPort->BSRR = pinout_config.NSS.GPIOPin;
+		}
+
+		bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length) {
+			for(uint16_t i = 0; i < length; i++) {
+				rx[i] = exchange(tx[i]);
+			}
+			return true;
+		}
+
+		bool write(const uint8_t* data, uint16_t length) {
+			for(uint16_t i = 0; i < length; i++) {
+				exchange(data[i]);
+			}
+			return true;
+		}
+
+		bool read(uint8_t* data, uint16_t length) {
+			for(uint16_t i = 0; i < length; i++) {
+				data[i] = exchange(0x00);
+			}
+			return true;
+		}
+
+		void reset() {
+			pinout_config.RESET.GPIOPort->BSRR = static_cast<uint32_t>(pinout_config.RESET.GPIOPin) << 16;
+			LL_mDelay(1);
+			pinout_config.RESET.GPIOPort->BSRR = pinout_config.RESET.GPIOPin;
+			LL_mDelay(10);
+		}
+
+		/** No interrupt-driven transfers; the driver's SPI engine runs each phase blocking instead **/
+		bool transfer_async(const uint8_t*, uint8_t*, uint16_t) { return false; }
+
+		uint32_t critical_enter() {
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			return primask;
+		}
+
+		void critical_exit(uint32_t primask) {
+			__set_PRIMASK(primask);
+		}
+
+#ifdef SX1278_SPI_DMA
+		bool write_dma(const uint8_t*, uint16_t) { return false; }
+		bool read_dma(uint8_t*, uint16_t) { return false; }
+		void read_dma_complete(uint8_t*, uint16_t) {}
+#endif
+
+	private:
+		LLPinoutConfig pinout_config;
+
+		uint8_t exchange(uint8_t value) {
+			while(!LL_SPI_IsActiveFlag_TXE(pinout_config.spi));
+			LL_SPI_TransmitData8(pinout_config.spi, value);
+			while(!LL_SPI_IsActiveFlag_RXNE(pinout_config.spi));
+			return LL_SPI_ReceiveData8(pinout_config.spi);
+		}
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_LLTRANSPORT_HPP
@@ -0,0 +1,124 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_MOCKTRANSPORT_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_MOCKTRANSPORT_HPP
+
+#include <cstdint>
+#include <cstring>
+
+#include "SX1278_Clock.hpp"
+
+namespace radio::sx1278 {
+	/**
+	 * Host bus backend: a plain register file behind a decoded SPI stream.
+	 *
+	 * The first byte after select() is the address (MSB set for write), every following byte reads or writes
+	 * the next register. Address 0x00 (RegFifo) goes to a 256-byte FIFO through RegFifoAddrPtr (0x0D).
+	 * There is no modem behaviour; it is meant for building and timing the driver off-target.
+	 */
+	class MockTransport {
+	public:
+		using clock = SteadyClock;
+
+		/** Register file and FIFO, public so a test harness can preset and inspect them **/
+		uint8_t registers[128] = {};
+		uint8_t fifo[256] = {};
+
+		/** Traffic counters **/
+		uint32_t transactions = 0;
+		uint32_t bytes = 0;
+
+		MockTransport() { reset(); };
+
+		void select() {
+			_selected = true;
+			_address_phase = true;
+			transactions++;
+		}
+
+		void deselect() {
+			_selected = false;
+		}
+
+		bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length) {
+			for(uint16_t i = 0; i < length; i++) {
+				rx[i] = exchange(tx[i]);
+			}
+			return _selected;
+		}
+
+		bool write(const uint8_t* data, uint16_t length) {
+			for(uint16_t i = 0; i < length; i++) {
+				exchange(data[i]);
+			}
+			return _selected;
+		}
+
+		bool read(uint8_t* data, uint16_t length) {
+			for(uint16_t i = 0; i < length; i++) {
+				data[i] = exchange(0x00);
+			}
+			return _selected;
+		}
+
+		void reset() {
+			std::memset(registers, 0, sizeof(registers));
+			std::memset(fifo, 0, sizeof(fifo));
+			registers[0x01] = 0x09; /** RegOpMode: FSK, LF, STDBY **/
+			registers[0x09] = 0x4F; /** RegPaConfig **/
+			registers[0x0C] = 0x20; /** RegLna **/
+			registers[0x1D] = 0x72; /** RegModemConfig1 **/
+			registers[0x1E] = 0x70; /** RegModemConfig2 **/
+			registers[0x31] = 0xC3; /** RegDetectOptimize **/
+			registers[0x42] = 0x12; /** RegVersion **/
+		}
+
+		/** Transfers always run blocking on the host, the driver's SPI engine completes them inline **/
+		bool transfer_async(const uint8_t*, uint8_t*, uint16_t) { return false; }
+
+		uint32_t critical_enter() { return 0; }
+		void critical_exit(uint32_t) {}
+
+#ifdef SX1278_SPI_DMA
+		bool write_dma(const uint8_t*, uint16_t) { return false; }
+		bool read_dma(uint8_t*, uint16_t) { return false; }
+		void read_dma_complete(uint8_t*, uint16_t) {}
+#endif
+
+	private:
+		static constexpr uint8_t fifo_addr_ptr = 0x0D;
+
+		bool _selected = false;
+		bool _address_phase = false;
+		bool _write = false;
+		uint8_t _address = 0;
+
+		uint8_t exchange(uint8_t value) {
+			bytes++;
+
+			if(_address_phase) {
+				_address_phase = false;
+				_write = value & 0x80;
+				_address = value & 0x7F;
+				return 0x00;
+			}
+
+			uint8_t out;
+			if(_address == 0x00) {
+				uint8_t& ptr = registers[fifo_addr_ptr];
+				out = fifo[ptr];
+				if(_write)
+					fifo[ptr] = value;
+				ptr++;
+				return out; /** FIFO access does not advance the address **/
+			}
+
+			out = registers[_address];
+			if(_write)
+				registers[_address] = value;
+			_address = (_address + 1) & 0x7F;
+			return out;
+		}
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_MOCKTRANSPORT_HPP
@@ -0,0 +1,54 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_PROFILER_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_PROFILER_HPP
+
+#include <cstdint>
+#include <cstring>
+
+namespace radio::sx1278 {
+	/** Bus usage of one register address **/
+	struct RegisterStats {
+		/** NSS transactions starting at this address **/
+		uint32_t transactions;
+		/** bytes clocked, address byte included **/
+		uint32_t bytes;
+		/** bus time in Clock ticks, NSS assert to NSS release **/
+		uint32_t ticks;
+	};
+
+	/**
+	 * Per-register SPI bus profiler, filled by the SX1278 SPI helpers when SX1278_PROFILER is defined.
+	 *
+	 * Transactions are attributed to their start address, so a FIFO burst counts against RegFifo and a
+	 * ModemConfig burst against RegModemConfig1.
+	 */
+	class BusProfiler {
+	public:
+		static constexpr uint8_t register_count = 128;
+
+		void record(uint8_t address, uint16_t bytes, uint32_t ticks) {
+			RegisterStats& entry = _stats[address & 0x7F];
+			entry.transactions++;
+			entry.bytes += bytes;
+			entry.ticks += ticks;
+		}
+
+		const RegisterStats& operator[](uint8_t address) const {
+			return _stats[address & 0x7F];
+		}
+
+		/** Copies the whole table, e.g. before printing it from a low priority task **/
+		void snapshot(RegisterStats (&out)[register_count]) const {
+			std::memcpy(out, _stats, sizeof(_stats));
+		}
+
+		void reset() {
+			std::memset(_stats, 0, sizeof(_stats));
+		}
+
+	private:
+		RegisterStats _stats[register_count] = {};
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_PROFILER_HPP
@@ -0,0 +1,68 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_REGISTERBATCH_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_REGISTERBATCH_HPP
+
+#include <cassert>
+#include <cstdint>
+
+namespace radio::sx1278 {
+	/**
+	 * Command list of register writes, flushed as auto-increment bursts.
+	 *
+	 * Writes are stored by address, so the list is always sorted and a later write to the same register
+	 * replaces the earlier one. On flush every run of adjacent addresses becomes a single NSS transaction.
+	 *
+	 * @note RegFifo (0x00) cannot be batched, FIFO access does not auto-increment the register address.
+	 */
+	class RegisterBatch {
+	public:
+		template <typename RegAddr>
+		void write(RegAddr addr, uint8_t value) {
+			static_assert(sizeof(RegAddr) == 1, "Register address must be 1 byte long");
+
+			auto address = static_cast<uint8_t>(addr) & 0x7F;
+			assert(address != 0x00);
+
+			values[address] = value;
+			pending[address >> 5] |= 1UL << (address & 0x1F);
+		}
+
+		bool empty() const {
+			return (pending[0] | pending[1] | pending[2] | pending[3]) == 0;
+		}
+
+		void clear() {
+			pending[0] = pending[1] = pending[2] = pending[3] = 0;
+		}
+
+		/**
+		 * @brief Calls fn(address, values, length) for every run of adjacent pending registers, in address order.
+		 */
+		template <typename Fn>
+		void for_each_run(Fn&& fn) const {
+			uint8_t address = 1;
+			while(address < 128) {
+				if(!is_pending(address)) {
+					address++;
+					continue;
+				}
+
+				uint8_t start = address;
+				while(address < 128 && is_pending(address)) {
+					address++;
+				}
+				fn(start, &values[start], static_cast<uint8_t>(address - start));
+			}
+		}
+
+	private:
+		uint8_t values[128];
+		uint32_t pending[4] = {};
+
+		bool is_pending(uint8_t address) const {
+			return pending[address >> 5] & (1UL << (address & 0x1F));
+		}
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_REGISTERBATCH_HPP
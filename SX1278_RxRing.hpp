@@ -0,0 +1,109 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_RXRING_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_RXRING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "SX1278_Clock.hpp"
+#include "SX1278_ControlTable.hpp"
+
+#ifndef SX1278_RX_RING_SLOTS
+#define SX1278_RX_RING_SLOTS 4
+#endif
+
+namespace radio::sx1278 {
+	/**
+	 * One received frame and what the modem reported about it.
+	 *
+	 * The payload fills whole 32-byte cache lines and the fields after it start a line of their own, so the cache
+	 * invalidate after a DMA drain into data never discards them.
+	 */
+	struct alignas(32) RxPacket {
+		/** up to 255 bytes used, the last one pads to a line boundary **/
+		uint8_t data[256];
+		alignas(32) uint8_t length;
+		/** RegIrqFlags at RxDone **/
+		uint8_t irq_flags;
+		/** packet SNR and RSSI **/
+		lora::PacketStatus status;
+		/** RxDone and end of preamble **/
+		EventTime time;
+
+		bool crc_error() const { return irq_flags & IrqFlags::PayloadCrcError; }
+	};
+	static_assert(offsetof(RxPacket, length) == 256 && sizeof(RxPacket) == 288,
+	              "RxPacket payload and metadata must sit on separate cache lines");
+
+	/**
+	 * Single-producer / single-consumer ring of packet slots, lock-free.
+	 *
+	 * The driver is the producer (from on_dio0_irq()), the application the consumer. A slot is written in place and
+	 * published with produce(), and read in place and released with pop(), so a frame is copied only once, from the
+	 * FIFO into its slot. When the ring is full, new frames are dropped and counted, the queued ones are kept.
+	 *
+	 * @tparam Slots Number of slots, a power of two.
+	 */
+	template <uint8_t Slots>
+	class RxRing {
+		static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "Slot count must be a power of two");
+
+	public:
+		/** Producer: slot to fill, nullptr if the ring is full **/
+		RxPacket* producer_slot() {
+			uint32_t head = _head.load(std::memory_order_relaxed);
+			if(head - _tail.load(std::memory_order_acquire) == Slots)
+				return nullptr;
+			return &_slots[head & (Slots - 1)];
+		}
+
+		/** Producer: publishes the slot returned by producer_slot() **/
+		void produce() {
+			_head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		/** Producer: records a frame dropped because the ring was full **/
+		void count_overflow() {
+			_overflows.store(_overflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		/** Producer: records a frame that could not be read (no RxDone, or no length in implicit header mode) **/
+		void count_drop() {
+			_drops.store(_drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		/** Consumer: oldest packet, nullptr if the ring is empty **/
+		const RxPacket* front() const {
+			uint32_t tail = _tail.load(std::memory_order_relaxed);
+			if(_head.load(std::memory_order_acquire) == tail)
+				return nullptr;
+			return &_slots[tail & (Slots - 1)];
+		}
+
+		/** Consumer: releases the packet returned by front() **/
+		void pop() {
+			_tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		uint8_t size() const {
+			return static_cast<uint8_t>(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+		}
+
+		/** Frames dropped because the consumer fell behind **/
+		uint32_t overflows() const { return _overflows.load(std::memory_order_relaxed); }
+
+		/** Frames lost because they could not be read from the FIFO **/
+		uint32_t drops() const { return _drops.load(std::memory_order_relaxed); }
+
+	private:
+		RxPacket _slots[Slots];
+		/** free running counters, the slot is the counter modulo Slots **/
+		std::atomic<uint32_t> _head{0};
+		std::atomic<uint32_t> _tail{0};
+		std::atomic<uint32_t> _overflows{0};
+		std::atomic<uint32_t> _drops{0};
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_RXRING_HPP
@@ -0,0 +1,496 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_SIMTRANSPORT_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_SIMTRANSPORT_HPP
+
+#include <cstdint>
+#include <cstring>
+
+#include "SX1278_ControlTable.hpp"
+
+namespace radio::sx1278 {
+	/** Simulated time base shared by all SimTransport instances, in microseconds **/
+	struct SimClock {
+		static inline uint32_t ticks = 0;
+
+		static uint32_t now() {
+			return ticks;
+		}
+
+		static uint32_t frequency() {
+			return 1000000UL;
+		}
+	};
+
+	/**
+	 * Host bus backend running the driver against a register-level SX1278 model.
+	 *
+	 * Modelled:
+	 * - the register file with datasheet reset values, read-only status registers and write-1-to-clear RegIrqFlags,
+	 * - the 256-byte FIFO behind RegFifo, addressed through RegFifoAddrPtr, with TX taken from RegFifoTxBaseAddr and
+	 *   packets stored from RegFifoRxBaseAddr (RegFifoRxCurrentAddr / RegFifoRxByteAddr / RegRxNbBytes updated),
+	 * - the OpMode state machine: LongRangeMode only writable in SLEEP, FIFO cleared in SLEEP, TX and CAD
+	 *   completing after a set duration and dropping back to STDBY, RXSINGLE dropping back to STDBY after a packet,
+	 * - IRQ flags honouring RegIrqFlagsMask, and DIO0 following the RegDioMapping1 selection (RxDone/TxDone/CadDone).
+	 *
+	 * Time only moves in advance(); packets are injected with inject_packet(). Transmitted frames and DIO0 rising
+	 * edges are reported through callbacks, so a harness can forward DIO0 to SX1278::on_dio0_irq() and loop two
+	 * simulated radios together. An edge caused by an SPI write is reported once NSS is released, like an
+	 * interrupt that fires after the transaction.
+	 */
+	class SimTransport {
+	public:
+		using clock = SimClock;
+
+		/** Register file and FIFO, public so a test harness can inspect them **/
+		uint8_t registers[128] = {};
+		uint8_t fifo[256] = {};
+
+		/** Time from entering TX until TxDone **/
+		uint32_t tx_duration_us = 1000;
+		/** Time from entering CAD until CadDone **/
+		uint32_t cad_duration_us = 500;
+		/** Result of the next CAD **/
+		bool channel_busy = false;
+		/** Leave transfer_async() transfers pending until complete_async() **/
+		bool defer_async = false;
+
+		/** Called on every DIO0 rising edge **/
+		void(*on_dio0)(void* context) = nullptr;
+		void* dio0_context = nullptr;
+
+		/** Called on TxDone with the transmitted payload **/
+		void(*on_transmit)(void* context, const uint8_t* data, uint8_t length) = nullptr;
+		void* transmit_context = nullptr;
+
+		/** Traffic counters **/
+		uint32_t transactions = 0;
+		uint32_t bytes = 0;
+
+		SimTransport() { reset(); };
+
+		void select() {
+			_selected = true;
+			_address_phase = true;
+			transactions++;
+		}
+
+		void deselect() {
+			_selected = false;
+			fire_dio0();
+		}
+
+		bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length) {
+			for(uint16_t i = 0; i < length; i++) {
+				rx[i] = exchange(tx[i]);
+			}
+			return _selected;
+		}
+
+		bool write(const uint8_t* data, uint16_t length) {
+			for(uint16_t i = 0; i < length; i++) {
+				exchange(data[i]);
+			}
+			return _selected;
+		}
+
+		bool read(uint8_t* data, uint16_t length) {
+			for(uint16_t i = 0; i < length; i++) {
+				data[i] = exchange(0x00);
+			}
+			return _selected;
+		}
+
+		void reset() {
+			std::memset(registers, 0, sizeof(registers));
+			std::memset(fifo, 0, sizeof(fifo));
+			registers[reg(RegisterAddress::RegOpMode)] = 0x09; /** FSK, LF, STDBY **/
+			registers[reg(RegisterAddress::RegFrMsb)] = 0x6C;
+			registers[reg(RegisterAddress::RegFrMid)] = 0x80;
+			registers[reg(RegisterAddress::RegPaConfig)] = 0x4F;
+			registers[reg(RegisterAddress::RegPaRamp)] = 0x09;
+			registers[reg(RegisterAddress::RegOcp)] = 0x2B;
+			registers[reg(RegisterAddress::RegLna)] = 0x20;
+			registers[reg(lora::RegisterAddress::RegFifoTxBaseAddr)] = 0x80;
+			registers[reg(lora::RegisterAddress::RegModemConfig1)] = 0x72;
+			registers[reg(lora::RegisterAddress::RegModemConfig2)] = 0x70;
+			registers[reg(lora::RegisterAddress::RegSymbTimeoutLsb)] = 0x64;
+			registers[reg(lora::RegisterAddress::RegPreambleLsb)] = 0x08;
+			registers[reg(lora::RegisterAddress::RegPayloadLength)] = 0x01;
+			registers[reg(lora::RegisterAddress::RegMaxPayloadLength)] = 0xFF;
+			registers[reg(lora::RegisterAddress::RegHopPeriod)] = 0x00;
+			registers[reg(lora::RegisterAddress::RegDetectOptimize)] = 0xC3;
+			registers[reg(lora::RegisterAddress::RegInvertIQ)] = 0x27;
+			registers[reg(lora::RegisterAddress::RegDetectionThreshold)] = 0x0A;
+			registers[reg(lora::RegisterAddress::RegSyncWord)] = 0x12;
+			registers[reg(RegisterAddress::RegVersion)] = 0x12;
+
+			_activity = Activity::NONE;
+			_dio0 = false;
+			_dio0_edge = false;
+			_rx_write_ptr = 0;
+		}
+
+		/**
+		 * Without defer_async the driver's SPI engine runs every transfer inline. With it, transfer_async() only
+		 * records the transfer; complete_async() clocks it later, like an SPI interrupt firing after the call.
+		 */
+		bool transfer_async(const uint8_t* tx, uint8_t* rx, uint16_t length) {
+			if(!defer_async)
+				return false;
+
+			_async_tx = tx;
+			_async_rx = rx;
+			_async_length = length;
+			_async_pending = true;
+			return true;
+		}
+
+		/**
+		 * @brief Clocks the transfer recorded by transfer_async().
+		 *
+		 * @return False if none was pending; otherwise the harness calls SX1278::on_spi_complete() next, as the
+		 *         transfer complete interrupt would.
+		 */
+		bool complete_async() {
+			if(!_async_pending)
+				return false;
+
+			_async_pending = false;
+			for(uint16_t i = 0; i < _async_length; i++) {
+				uint8_t value = exchange(_async_tx != nullptr ? _async_tx[i] : 0x00);
+				if(_async_rx != nullptr)
+					_async_rx[i] = value;
+			}
+			return true;
+		}
+
+		uint32_t critical_enter() { return 0; }
+		void critical_exit(uint32_t) {}
+
+#ifdef SX1278_SPI_DMA
+		/** Accept read_dma() / write_dma() and leave them pending until complete_dma(), otherwise they are refused **/
+		bool defer_dma = false;
+
+		bool write_dma(const uint8_t* data, uint16_t length) {
+			if(!defer_dma)
+				return false;
+
+			_dma_tx = data;
+			_dma_rx = nullptr;
+			_dma_length = length;
+			_dma_pending = true;
+			return true;
+		}
+
+		/**
+		 * Besides recording the transfer, keeps the 32-byte lines around the buffer as they are in memory when the
+		 * DMA starts, for read_dma_complete().
+		 */
+		bool read_dma(uint8_t* data, uint16_t length) {
+			if(!defer_dma)
+				return false;
+
+			_dma_tx = nullptr;
+			_dma_rx = data;
+			_dma_length = length;
+			_dma_pending = true;
+			_dma_lines = reinterpret_cast<uint8_t*>(reinterpret_cast<uintptr_t>(data) & ~uintptr_t{31});
+			_dma_lines_length = static_cast<uint16_t>(((data + length - _dma_lines) + 31) & ~31);
+			std::memcpy(_dma_lines_memory, _dma_lines, _dma_lines_length);
+			return true;
+		}
+
+		/**
+		 * Emulates the cache invalidate of the received lines: bytes that share a line with the buffer but were
+		 * written by the CPU while the DMA ran are lost, they fall back to what memory held at read_dma().
+		 */
+		void read_dma_complete(uint8_t* data, uint16_t length) {
+			if(_dma_lines == nullptr)
+				return;
+
+			for(uint16_t i = 0; i < _dma_lines_length; i++) {
+				uint8_t* byte = _dma_lines + i;
+				if(byte < data || byte >= data + length)
+					*byte = _dma_lines_memory[i];
+			}
+			_dma_lines = nullptr;
+		}
+
+		/**
+		 * @brief Clocks the transfer recorded by read_dma() / write_dma().
+		 *
+		 * @return False if none was pending; otherwise the harness calls SX1278::on_spi_complete() next, as the
+		 *         DMA complete interrupt would.
+		 */
+		bool complete_dma() {
+			if(!_dma_pending)
+				return false;
+
+			_dma_pending = false;
+			for(uint16_t i = 0; i < _dma_length; i++) {
+				uint8_t value = exchange(_dma_tx != nullptr ? _dma_tx[i] : 0x00);
+				if(_dma_rx != nullptr)
+					_dma_rx[i] = value;
+			}
+			return true;
+		}
+#endif
+
+		/**
+		 * @brief Moves simulated time forward, completing TX and CAD whose duration has elapsed.
+		 *
+		 * @note SimClock is shared; with several simulated radios advance one and call update() on the others.
+		 */
+		void advance(uint32_t us) {
+			SimClock::ticks += us;
+			update();
+		}
+
+		/**
+		 * @brief Completes TX and CAD whose duration has elapsed at the current SimClock time.
+		 */
+		void update() {
+			if(_activity == Activity::NONE || static_cast<int32_t>(SimClock::ticks - _activity_end) < 0)
+				return;
+
+			if(_activity == Activity::TX) {
+				finish_transmit();
+			} else if(_activity == Activity::CAD) {
+				_activity = Activity::NONE;
+				set_mode_bits(lora::Mode::STDBY);
+				raise(channel_busy ? (IrqFlags::CadDone | IrqFlags::CadDetected) : IrqFlags::CadDone);
+			}
+			fire_dio0();
+		}
+
+		/**
+		 * @brief Delivers a packet to the modem as if it had been received over the air.
+		 *
+		 * @param snr Packet SNR in dB, stored in RegPktSnrValue as SNR * 4.
+		 * @param rssi Raw RegPktRssiValue.
+		 * @param crc_error Set PayloadCrcError together with RxDone.
+		 *
+		 * @return False if the modem is not in LoRa RXCONTINUOUS/RXSINGLE mode, the packet is then lost.
+		 */
+		bool inject_packet(const uint8_t* data, uint8_t length, int8_t snr = 10, uint8_t rssi = 100, bool crc_error = false) {
+			if(!is_lora() || (mode() != lora::Mode::RXCONTINUOUS && mode() != lora::Mode::RXSINGLE))
+				return false;
+
+			bool explicit_header = !(registers[reg(lora::RegisterAddress::RegModemConfig1)] & 0x01);
+			if(explicit_header && length > registers[reg(lora::RegisterAddress::RegMaxPayloadLength)])
+				return false; /** header rejected by the modem, nothing reaches the FIFO **/
+
+			uint8_t start = _rx_write_ptr;
+			for(uint8_t i = 0; i < length; i++) {
+				fifo[_rx_write_ptr++] = data[i];
+			}
+
+			registers[reg(lora::RegisterAddress::RegFiFoRxCurrentAddr)] = start;
+			registers[reg(lora::RegisterAddress::RegFifoRxByteAddr)] = _rx_write_ptr;
+			registers[reg(lora::RegisterAddress::RegRxNbBytes)] = length;
+			registers[reg(lora::RegisterAddress::RegPktSnrValue)] = static_cast<uint8_t>(snr * 4);
+			registers[reg(lora::RegisterAddress::RegPktRssiValue)] = rssi;
+
+			if(mode() == lora::Mode::RXSINGLE)
+				set_mode_bits(lora::Mode::STDBY);
+
+			uint8_t flags = IrqFlags::RxDone;
+			if(explicit_header)
+				flags |= IrqFlags::ValidHeader;
+			if(crc_error)
+				flags |= IrqFlags::PayloadCrcError;
+			raise(flags);
+			fire_dio0();
+			return true;
+		}
+
+		bool dio0() const {
+			return _dio0;
+		}
+
+		lora::Mode mode() const {
+			return static_cast<lora::Mode>(registers[reg(RegisterAddress::RegOpMode)] & 0x07);
+		}
+
+		bool is_lora() const {
+			return registers[reg(RegisterAddress::RegOpMode)] & 0x80;
+		}
+
+	private:
+		enum class Activity : uint8_t {
+			NONE,
+			TX,
+			CAD,
+		};
+
+		bool _selected = false;
+		bool _address_phase = false;
+		bool _write = false;
+		uint8_t _address = 0;
+
+		Activity _activity = Activity::NONE;
+		uint32_t _activity_end = 0;
+		bool _dio0 = false;
+		bool _dio0_edge = false;
+		uint8_t _rx_write_ptr = 0;
+
+		const uint8_t* _async_tx = nullptr;
+		uint8_t* _async_rx = nullptr;
+		uint16_t _async_length = 0;
+		bool _async_pending = false;
+
+#ifdef SX1278_SPI_DMA
+		const uint8_t* _dma_tx = nullptr;
+		uint8_t* _dma_rx = nullptr;
+		uint16_t _dma_length = 0;
+		bool _dma_pending = false;
+		uint8_t* _dma_lines = nullptr;
+		uint16_t _dma_lines_length = 0;
+		uint8_t _dma_lines_memory[256 + 32];
+#endif
+
+		template <typename RegAddr>
+		static constexpr uint8_t reg(RegAddr addr) {
+			return static_cast<uint8_t>(addr);
+		}
+
+		static bool is_read_only(uint8_t address) {
+			return address == reg(lora::RegisterAddress::RegFiFoRxCurrentAddr) ||
+			       (address >= reg(lora::RegisterAddress::RegRxNbBytes) && address <= reg(lora::RegisterAddress::RegModemStat)) ||
+			       (address >= reg(lora::RegisterAddress::RegPktSnrValue) && address <= reg(lora::RegisterAddress::RegHopChannel)) ||
+			       address == reg(lora::RegisterAddress::RegFifoRxByteAddr) ||
+			       address == reg(RegisterAddress::RegVersion);
+		}
+
+		uint8_t exchange(uint8_t value) {
+			bytes++;
+
+			if(_address_phase) {
+				_address_phase = false;
+				_write = value & 0x80;
+				_address = value & 0x7F;
+				return 0x00;
+			}
+
+			if(_address == reg(RegisterAddress::RegFifo)) {
+				return fifo_access(value); /** FIFO access does not advance the address **/
+			}
+
+			uint8_t out = registers[_address];
+			if(_write)
+				write_register(_address, value);
+			_address = (_address + 1) & 0x7F;
+			return out;
+		}
+
+		uint8_t fifo_access(uint8_t value) {
+			if(!is_lora() || mode() == lora::Mode::SLEEP)
+				return 0x00; /** FIFO is not accessible in SLEEP **/
+
+			uint8_t& ptr = registers[reg(lora::RegisterAddress::RegFifoAddrPtr)];
+			uint8_t out = fifo[ptr];
+			if(_write)
+				fifo[ptr] = value;
+			ptr++;
+			return out;
+		}
+
+		void write_register(uint8_t address, uint8_t value) {
+			if(address == reg(RegisterAddress::RegOpMode)) {
+				write_op_mode(value);
+			} else if(address == reg(lora::RegisterAddress::RegIrqFlags)) {
+				registers[address] &= ~value; /** write 1 to clear **/
+				update_dio0();
+			} else if(address == reg(RegisterAddress::RegDioMapping1)) {
+				registers[address] = value;
+				update_dio0();
+			} else if(!is_read_only(address)) {
+				registers[address] = value;
+			}
+		}
+
+		void write_op_mode(uint8_t value) {
+			uint8_t& op_mode = registers[reg(RegisterAddress::RegOpMode)];
+
+			if(static_cast<lora::Mode>(op_mode & 0x07) != lora::Mode::SLEEP) {
+				value = (value & 0x7F) | (op_mode & 0x80); /** LongRangeMode can only change in SLEEP **/
+			}
+			op_mode = value;
+
+			_activity = Activity::NONE;
+			switch(mode()) {
+				case lora::Mode::SLEEP:
+					std::memset(fifo, 0, sizeof(fifo));
+					break;
+				case lora::Mode::TX:
+					_activity = Activity::TX;
+					_activity_end = SimClock::ticks + tx_duration_us;
+					break;
+				case lora::Mode::RXCONTINUOUS:
+				case lora::Mode::RXSINGLE:
+					_rx_write_ptr = registers[reg(lora::RegisterAddress::RegFifoRxBaseAddr)];
+					break;
+				case lora::Mode::CAD:
+					_activity = Activity::CAD;
+					_activity_end = SimClock::ticks + cad_duration_us;
+					break;
+				default:
+					break;
+			}
+		}
+
+		void set_mode_bits(lora::Mode mode) {
+			uint8_t& op_mode = registers[reg(RegisterAddress::RegOpMode)];
+			op_mode = (op_mode & 0xF8) | static_cast<uint8_t>(mode);
+		}
+
+		void finish_transmit() {
+			_activity = Activity::NONE;
+			set_mode_bits(lora::Mode::STDBY);
+
+			uint8_t frame[256];
+			uint8_t length = registers[reg(lora::RegisterAddress::RegPayloadLength)];
+			uint8_t base = registers[reg(lora::RegisterAddress::RegFifoTxBaseAddr)];
+			for(uint16_t i = 0; i < length; i++) {
+				frame[i] = fifo[static_cast<uint8_t>(base + i)];
+			}
+
+			if(on_transmit != nullptr)
+				on_transmit(transmit_context, frame, length);
+
+			raise(IrqFlags::TxDone);
+		}
+
+		void raise(uint8_t flags) {
+			flags &= ~registers[reg(lora::RegisterAddress::RegIrqFlagsMask)];
+			registers[reg(lora::RegisterAddress::RegIrqFlags)] |= flags;
+			update_dio0();
+		}
+
+		void update_dio0() {
+			uint8_t mapped;
+			switch(registers[reg(RegisterAddress::RegDioMapping1)] >> 6) {
+				case 0b00: mapped = IrqFlags::RxDone; break;
+				case 0b01: mapped = IrqFlags::TxDone; break;
+				case 0b10: mapped = IrqFlags::CadDone; break;
+				default: mapped = 0; break;
+			}
+
+			bool level = registers[reg(lora::RegisterAddress::RegIrqFlags)] & mapped;
+			if(level && !_dio0)
+				_dio0_edge = true;
+			_dio0 = level;
+		}
+
+		void fire_dio0() {
+			if(!_dio0_edge || _selected)
+				return;
+
+			_dio0_edge = false;
+			if(on_dio0 != nullptr)
+				on_dio0(dio0_context);
+		}
+	};
+
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_SX1278_SIMTRANSPORT_HPP
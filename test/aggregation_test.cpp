@@ -0,0 +1,50 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+#include "SX1278_Aggregation.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	Radio* peer;
+	uint8_t received[256];
+	int received_length = -1;
+}
+
+int main() {
+	test::SimLink<Radio> link;
+	CHECK(link.initialised);
+	peer = &link.b;
+	link.b.on_rx = [] { received_length = peer->getReceivedData(received); };
+
+	Aggregator aggregator{300};
+	const uint8_t first[] = {'t', '=', '2', '1'};
+	const uint8_t second[] = {'p', '=', '9', '9', '8'};
+	CHECK(aggregator.push(first, sizeof(first), 0));
+	CHECK(aggregator.push(second, sizeof(second), 10));
+	CHECK(!aggregator.should_flush(100));
+	CHECK(aggregator.should_flush(300));
+
+	/** the usage from the Aggregator documentation, the flushed frame is const **/
+	if(aggregator.should_flush(300)) {
+		auto frame = aggregator.flush();
+		link.a.startTransmit(frame.data(), frame.size());
+	}
+	link.advance(link.a.get_transport().tx_duration_us);
+	CHECK_EQ(received_length, 1 + 1 + 4 + 1 + 5);
+
+	Deaggregator messages{received, static_cast<uint8_t>(received_length)};
+	auto message = messages.next();
+	CHECK(message.has_value() && message->size() == sizeof(first) && std::memcmp(message->data(), first, sizeof(first)) == 0);
+	message = messages.next();
+	CHECK(message.has_value() && message->size() == sizeof(second) && std::memcmp(message->data(), second, sizeof(second)) == 0);
+	CHECK(!messages.next().has_value());
+	CHECK(messages.is_valid());
+
+	return test::result();
+}
@@ -0,0 +1,62 @@
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	Radio* sender;
+	uint32_t loaded_ticks = 0;
+	uint32_t loaded_done_ticks = 0;
+
+	/** TxDone minus end of preamble: the payload part of the airtime, set by the frame length **/
+	uint32_t payload_ticks(const Radio& radio) {
+		return radio.get_tx_time().done - radio.get_tx_time().preamble_end;
+	}
+}
+
+int main() {
+	test::SimLink<Radio> link;
+	CHECK(link.initialised);
+	auto& bus = link.a.get_transport();
+	sender = &link.a;
+	uint8_t payload[40] = {};
+
+	/** references from blocking transmissions **/
+	link.a.startTransmit(payload, 40);
+	link.advance(bus.tx_duration_us);
+	uint32_t long_frame = payload_ticks(link.a);
+	link.a.startTransmit(payload, 3);
+	link.advance(bus.tx_duration_us);
+	CHECK(payload_ticks(link.a) < long_frame);
+
+	/** the async frame is timed with its own length, not the one of the previous transmission **/
+	for(bool deferred : {false, true}) {
+		bus.defer_async = deferred;
+		loaded_ticks = 0;
+		CHECK(link.a.startTransmitAsync(payload, 40, [] {
+			loaded_ticks = SimClock::now();
+			loaded_done_ticks = sender->get_tx_done_time();
+		}));
+		bus.advance(10); /** the SPI interrupts come later **/
+		while(bus.complete_async())
+			link.a.on_spi_complete();
+		CHECK(loaded_ticks != 0);
+		/** start-up from STDBY: PLL lock (60 us) and PA ramp (40 us), then the airtime **/
+		CHECK_EQ(loaded_done_ticks, loaded_ticks + 60 + 40 + link.a.get_time_on_air_us(40));
+		CHECK_EQ(link.a.get_tx_done_time(), loaded_done_ticks);
+		CHECK(!link.a.get_tx_start_latency().prelocked);
+
+		link.advance(bus.tx_duration_us);
+		CHECK_EQ(payload_ticks(link.a), long_frame);
+
+		link.a.startTransmit(payload, 3);
+		link.advance(bus.tx_duration_us);
+	}
+	bus.defer_async = false;
+
+	return test::result();
+}
@@ -0,0 +1,210 @@
+#include <cstdio>
+
+#include "SX1278_MockTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+
+using namespace radio::sx1278;
+
+namespace {
+	/**
+	 * MockTransport counting the blocking bus calls; on target every one of them is a HAL_SPI_* call with its
+	 * entry / exit overhead, which is what dominates a 2-byte register access.
+	 */
+	struct CountingTransport : MockTransport {
+		uint32_t calls = 0;
+
+		bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length) {
+			calls++;
+			return MockTransport::transfer(tx, rx, length);
+		}
+
+		bool write(const uint8_t* data, uint16_t length) {
+			calls++;
+			return MockTransport::write(data, length);
+		}
+
+		bool read(uint8_t* data, uint16_t length) {
+			calls++;
+			return MockTransport::read(data, length);
+		}
+	};
+
+	using Radio = SX1278<CountingTransport>;
+
+	/** Simulated time of TimedTransport, in microseconds **/
+	struct BusClock {
+		static inline uint32_t ticks = 0;
+
+		static uint32_t now() { return ticks; }
+		static uint32_t frequency() { return 1000000UL; }
+	};
+
+	/**
+	 * CountingTransport charging a bus time model to BusClock: every HAL transfer call costs its entry / exit
+	 * overhead plus 2 us per byte (4 MHz SCK), and a HAL_SPI_GetState spin after a call costs poll_us. The costs
+	 * are assumptions for a 72 MHz Cortex-M, not a capture, so the figures are modelled bus time; what they
+	 * compare is the call structure of the two access shapes, timed with the same clock.
+	 */
+	struct TimedTransport : CountingTransport {
+		using clock = BusClock;
+
+		static constexpr uint32_t call_us = 4;
+		static constexpr uint32_t byte_us = 2;
+		static constexpr uint32_t poll_us = 1;
+
+		bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length) {
+			BusClock::ticks += call_us + byte_us * length;
+			return CountingTransport::transfer(tx, rx, length);
+		}
+
+		bool write(const uint8_t* data, uint16_t length) {
+			BusClock::ticks += call_us + byte_us * length;
+			return CountingTransport::write(data, length);
+		}
+
+		bool read(uint8_t* data, uint16_t length) {
+			BusClock::ticks += call_us + byte_us * length;
+			return CountingTransport::read(data, length);
+		}
+
+		void poll_state() {
+			BusClock::ticks += poll_us;
+		}
+	};
+
+	using TimedRadio = SX1278<TimedTransport>;
+
+	/** The register write before the single-transfer change: address and value as two calls, each followed by a poll **/
+	uint32_t legacy_write(TimedTransport& bus, uint8_t address, uint8_t value) {
+		uint32_t start = BusClock::now();
+		address |= 0x80;
+		bus.select();
+		bus.write(&address, 1);
+		bus.poll_state();
+		bus.write(&value, 1);
+		bus.poll_state();
+		bus.deselect();
+		return BusClock::now() - start;
+	}
+
+	/** The register read before the change: address call and value call, each followed by a poll **/
+	uint32_t legacy_read(TimedTransport& bus, uint8_t address, uint8_t& value) {
+		uint32_t start = BusClock::now();
+		address &= 0x7F;
+		bus.select();
+		bus.write(&address, 1);
+		bus.poll_state();
+		bus.read(&value, 1);
+		bus.poll_state();
+		bus.deselect();
+		return BusClock::now() - start;
+	}
+
+	struct Access {
+		uint32_t calls;
+		uint32_t transactions;
+		uint32_t bytes;
+	};
+
+	template <typename Operation>
+	Access measure(Radio& radio, Operation operation) {
+		auto& bus = radio.get_transport();
+		Access before = {bus.calls, bus.transactions, bus.bytes};
+		operation();
+		return {bus.calls - before.calls, bus.transactions - before.transactions, bus.bytes - before.bytes};
+	}
+
+	void report(const char* name, const Access& access) {
+		std::printf("%-28s %2u NSS transaction(s) %2u bus call(s) %4u bytes\n", name,
+		            static_cast<unsigned>(access.transactions), static_cast<unsigned>(access.calls),
+		            static_cast<unsigned>(access.bytes));
+	}
+}
+
+int main() {
+	Radio radio{CountingTransport{}};
+	CHECK(radio.init() == Status::OK);
+	radio.set_mode(lora::Mode::STDBY);
+
+	/** register write: address and value in one full-duplex call (was 2 calls + 2 HAL_SPI_GetState polls) **/
+	auto write = measure(radio, [&] { radio.set_power(lora::Power::POWER_20_DB); });
+	report("register write (set_power)", write);
+	CHECK_EQ(write.transactions, 1U);
+	CHECK_EQ(write.calls, 1U);
+	CHECK_EQ(write.bytes, 2U);
+
+	/** register read: address and dummy byte in one call, value in the second byte (was 2 calls + 2 polls) **/
+	uint8_t version = 0;
+	auto read = measure(radio, [&] { version = radio.get_version(); });
+	report("register read (get_version)", read);
+	CHECK_EQ(version, 0x12);
+	CHECK_EQ(read.transactions, 1U);
+	CHECK_EQ(read.calls, 1U);
+	CHECK_EQ(read.bytes, 2U);
+
+	/** bursts keep an address call and a payload call under one NSS assertion, without the state polls **/
+	static uint8_t payload[64];
+	CHECK(radio.set_fifo_slots(1, sizeof(payload)));
+	auto burst_write = measure(radio, [&] { radio.stage_frame(0, payload, sizeof(payload)); });
+	report("64-byte FIFO burst write", burst_write);
+	CHECK_EQ(burst_write.bytes - 2 * (burst_write.transactions - 1), 1U + sizeof(payload)); /** plus 2-byte pointer / mode writes **/
+	CHECK_EQ(burst_write.calls, burst_write.transactions + 1);
+
+	uint8_t buffer[64];
+	radio.get_transport().registers[0x12] = 0x40; /** RxDone **/
+	radio.get_transport().registers[0x13] = sizeof(buffer); /** RegRxNbBytes **/
+	auto burst_read = measure(radio, [&] { radio.getReceivedData(buffer); });
+	report("RX drain (status + 64 B)", burst_read);
+
+	/** status burst and FIFO burst take two calls each, FifoAddrPtr and the IRQ clear one each **/
+	CHECK_EQ(burst_read.transactions, 4U);
+	CHECK_EQ(burst_read.calls, 6U);
+
+	/** the profiler attributes the same traffic per register **/
+	auto& profile = radio.profiler();
+	CHECK_EQ(profile[0x42].transactions, 2U); /** RegVersion: init() and get_version() **/
+	CHECK_EQ(profile[0x42].bytes, 4U);
+	CHECK_EQ(profile[0x00].transactions, 2U); /** the staged frame and the drain **/
+	CHECK_EQ(profile[0x00].bytes, 2 * (1U + sizeof(buffer)));
+
+	/** bus time per register access, before and after, measured with BusClock on the modelled transport **/
+	TimedRadio timed{TimedTransport{}};
+	CHECK(timed.init() == Status::OK);
+	auto& timed_bus = timed.get_transport();
+	const auto& timed_profile = timed.profiler();
+	constexpr uint8_t reg_pa_config = 0x09;
+	constexpr uint8_t reg_version = 0x42;
+
+	uint32_t ticks = timed_profile[reg_pa_config].ticks;
+	timed.set_power(lora::Power::POWER_20_DB);
+	uint32_t write_after = timed_profile[reg_pa_config].ticks - ticks;
+	uint32_t write_before = legacy_write(timed_bus, reg_pa_config, 0xFF);
+
+	ticks = timed_profile[reg_version].ticks;
+	CHECK_EQ(timed.get_version(), 0x12);
+	uint32_t read_after = timed_profile[reg_version].ticks - ticks;
+	uint8_t legacy_version = 0;
+	uint32_t read_before = legacy_read(timed_bus, reg_version, legacy_version);
+	CHECK_EQ(legacy_version, 0x12);
+
+	std::printf("register write: %u us before, %u us after (modelled)\n", static_cast<unsigned>(write_before),
+	            static_cast<unsigned>(write_after));
+	std::printf("register read:  %u us before, %u us after (modelled)\n", static_cast<unsigned>(read_before),
+	            static_cast<unsigned>(read_after));
+	/** 2 calls + 2 polls + 4 us of clocking before, 1 call + 4 us after **/
+	CHECK_EQ(write_before, 2 * TimedTransport::call_us + 2 * TimedTransport::poll_us + 2 * TimedTransport::byte_us);
+	CHECK_EQ(write_after, TimedTransport::call_us + 2 * TimedTransport::byte_us);
+	CHECK_EQ(read_before, write_before);
+	CHECK_EQ(read_after, write_after);
+
+	/** init() is register traffic only **/
+	Radio fresh{CountingTransport{}};
+	auto init = measure(fresh, [&] { CHECK(fresh.init() == Status::OK); });
+	report("init()", init);
+	std::printf("init: %u bytes in %u calls, %.2f calls per transaction\n", static_cast<unsigned>(init.bytes),
+	            static_cast<unsigned>(init.calls), static_cast<double>(init.calls) / init.transactions);
+
+	return test::result();
+}
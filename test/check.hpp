@@ -0,0 +1,38 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_TEST_CHECK_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_TEST_CHECK_HPP
+
+#include <cstdio>
+
+namespace test {
+	inline int failures = 0;
+
+	/** Prints the summary, use as the return value of main() **/
+	inline int result() {
+		if(failures != 0)
+			std::printf("%d check(s) failed\n", failures);
+		return failures == 0 ? 0 : 1;
+	}
+}
+
+/** Records a failed condition and keeps going, so one run reports every broken check **/
+#define CHECK(condition) \
+	do { \
+		if(!(condition)) { \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			test::failures++; \
+		} \
+	} while(0)
+
+/** CHECK for integral values, prints both sides on failure **/
+#define CHECK_EQ(actual, expected) \
+	do { \
+		auto _actual = (actual); \
+		auto _expected = (expected); \
+		if(!(_actual == _expected)) { \
+			std::printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #actual, #expected, \
+			            static_cast<long long>(_actual), static_cast<long long>(_expected)); \
+			test::failures++; \
+		} \
+	} while(0)
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_TEST_CHECK_HPP
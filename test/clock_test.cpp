@@ -0,0 +1,32 @@
+#include "SX1278_Clock.hpp"
+#include "SX1278_SimTransport.hpp"
+
+#include "check.hpp"
+
+using namespace radio::sx1278;
+
+namespace {
+	/** Stand-in for DwtClock on a 480 MHz core **/
+	struct CycleClock {
+		static uint32_t now() { return 0; }
+		static uint32_t frequency() { return 480000000UL; }
+	};
+}
+
+int main() {
+	/** microsecond ticks: intervals up to 71 minutes convert exactly **/
+	CHECK_EQ(SteadyClock::frequency(), 1000000U);
+	CHECK_EQ(us_to_ticks<SteadyClock>(10000000U), 10000000U);
+	CHECK_EQ(ticks_to_us<SteadyClock>(4000000000U), 4000000000U);
+
+	uint32_t before = SteadyClock::now();
+	uint32_t after = SteadyClock::now();
+	CHECK(after - before < 1000000U);
+
+	/** 64-bit products: 8 s at 480 MHz is 3.84e9 cycles, past 2^31 but within 2^32 **/
+	CHECK_EQ(us_to_ticks<CycleClock>(8000000U), 3840000000U);
+	CHECK_EQ(ticks_to_us<CycleClock>(3840000000U), 8000000U);
+	CHECK_EQ(us_to_ticks<SimClock>(123456U), 123456U);
+
+	return test::result();
+}
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#endif
+
+#include "SX1278_Compression.hpp"
+
+#include "check.hpp"
+
+using namespace radio::sx1278;
+
+namespace {
+	/**
+	 * Synthetic telemetry: the same record layout every frame with slowly drifting values, as sent by a sensor node.
+	 * Text frames are key=value lines, binary frames a packed struct.
+	 */
+	struct Corpus {
+		std::vector<std::vector<uint8_t>> frames;
+		std::vector<uint8_t> dictionary;
+	};
+
+	uint32_t next_random(uint32_t& state) {
+		state = state * 1664525UL + 1013904223UL;
+		return state >> 8;
+	}
+
+	Corpus text_corpus(int count) {
+		Corpus corpus;
+		uint32_t seed = 1;
+		int temperature = 2150, pressure = 101325, humidity = 455, battery = 3987;
+		for(int i = 0; i < count + 1; i++) {
+			temperature += static_cast<int>(next_random(seed) % 7) - 3;
+			pressure += static_cast<int>(next_random(seed) % 11) - 5;
+			humidity += static_cast<int>(next_random(seed) % 5) - 2;
+			battery -= static_cast<int>(next_random(seed) % 2);
+			char line[255];
+			int length = std::snprintf(line, sizeof(line),
+			                           "node=17;seq=%d;t=%d.%02d;p=%d;rh=%d.%d;vbat=%d;lat=52.22977;lon=21.01178;state=OK",
+			                           i, temperature / 100, temperature % 100, pressure, humidity / 10, humidity % 10,
+			                           battery);
+			std::vector<uint8_t> frame(line, line + length);
+			if(i == 0)
+				corpus.dictionary = frame; /** a typical frame, shared by both ends **/
+			else
+				corpus.frames.push_back(frame);
+		}
+		return corpus;
+	}
+
+	Corpus binary_corpus(int count) {
+		Corpus corpus;
+		uint32_t seed = 7;
+		int16_t channels[12] = {};
+		for(int i = 0; i < count + 1; i++) {
+			std::vector<uint8_t> frame = {0xA5, 0x17, static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)};
+			for(auto& channel : channels) {
+				channel = static_cast<int16_t>(channel + static_cast<int>(next_random(seed) % 9) - 4);
+				frame.push_back(static_cast<uint8_t>(channel));
+				frame.push_back(static_cast<uint8_t>(channel >> 8));
+			}
+			frame.insert(frame.end(), 16, 0x00); /** reserved / unused fields **/
+			if(i == 0)
+				corpus.dictionary = frame;
+			else
+				corpus.frames.push_back(frame);
+		}
+		return corpus;
+	}
+
+	uint64_t cycles() {
+#ifdef BENCH_HAS_TSC
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+
+	/** Compresses and decompresses the whole corpus, checks the round trip and prints ratio and cost per input byte **/
+	double run(const char* name, const Corpus& corpus, bool with_dictionary) {
+		etl::span<const uint8_t> dictionary;
+		if(with_dictionary)
+			dictionary = etl::span<const uint8_t>(corpus.dictionary.data(), corpus.dictionary.size());
+
+		compression::Compressor compressor{dictionary};
+		std::size_t in_bytes = 0;
+		std::size_t out_bytes = 0;
+		uint8_t compressed[256];
+		uint8_t restored[compression::in_place_capacity];
+
+		constexpr int rounds = 50;
+		auto start = std::chrono::steady_clock::now();
+		uint64_t start_cycles = cycles();
+		for(int round = 0; round < rounds; round++) {
+			for(const auto& frame : corpus.frames) {
+				uint8_t length = compressor.compress(frame.data(), static_cast<uint8_t>(frame.size()), compressed);
+				if(round == 0) {
+					in_bytes += frame.size();
+					out_bytes += length;
+				}
+			}
+		}
+		uint64_t total_cycles = cycles() - start_cycles;
+		auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		for(const auto& frame : corpus.frames) {
+			uint8_t length = compressor.compress(frame.data(), static_cast<uint8_t>(frame.size()), compressed);
+			std::memcpy(restored, compressed, length);
+			auto result = compression::decompress_in_place(restored, length, sizeof(restored), dictionary);
+			CHECK(result.has_value());
+			CHECK(result.value_or(0) == frame.size());
+			CHECK(std::memcmp(restored, frame.data(), frame.size()) == 0);
+		}
+
+		double ratio = static_cast<double>(out_bytes) / static_cast<double>(in_bytes);
+		double processed = static_cast<double>(in_bytes) * rounds;
+		std::printf("%-8s %-13s %5zu B -> %5zu B  ratio %.3f  %6.1f ns/B", name,
+		            with_dictionary ? "dictionary" : "no dictionary", in_bytes, out_bytes, ratio, elapsed / processed);
+		if(total_cycles != 0)
+			std::printf("  %6.1f cycles/B", static_cast<double>(total_cycles) / processed);
+		std::printf("\n");
+		return ratio;
+	}
+}
+
+int main() {
+	auto text = text_corpus(200);
+	auto binary = binary_corpus(200);
+
+	double text_plain = run("text", text, false);
+	double text_dictionary = run("text", text, true);
+	double binary_plain = run("binary", binary, false);
+	double binary_dictionary = run("binary", binary, true);
+
+	/** the shared dictionary is what makes short telemetry frames compress at all **/
+	CHECK(text_dictionary < text_plain);
+	CHECK(text_dictionary < 0.6);
+	CHECK(binary_dictionary <= binary_plain);
+	CHECK(text_plain <= 1.0 + 1.0 / 80); /** never worse than stored: +1 byte on ~84-byte frames **/
+
+	return test::result();
+}
@@ -0,0 +1,112 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	constexpr uint8_t reg_irq_flags = 0x12;
+
+	uint8_t buffer[16];
+	int step = 0;
+	etl::optional<uint8_t> received;
+	bool activity = true;
+	uint8_t irq_flags_after_cad = 0xFF;
+
+	Task receive_then_cad(Radio& radio, uint32_t deadline) {
+		received = co_await radio.receive(etl::span<uint8_t>(buffer), deadline);
+		step = 1;
+		activity = co_await radio.cad();
+		irq_flags_after_cad = radio.get_transport().registers[reg_irq_flags];
+		step = 2;
+	}
+
+	/** Lets the interrupt-driven transfers run one by one, as the SPI interrupt would **/
+	void run_spi(Radio& radio) {
+		while(radio.get_transport().complete_async()) {
+			radio.on_spi_complete();
+		}
+	}
+}
+
+int main() {
+	Radio radio{SimTransport{}};
+	auto& bus = radio.get_transport();
+	CHECK(radio.init() == Status::OK);
+	test::wire_dio0(radio);
+	radio.startReceive();
+	bus.defer_async = true;
+
+	auto task = receive_then_cad(radio, SimClock::ticks + 100);
+	CHECK(static_cast<bool>(task));
+
+	/** RxDone queues the drain; the deadline passes before the SPI interrupt has run any of it **/
+	const uint8_t packet[] = {'p', 'i', 'n', 'g'};
+	CHECK(bus.inject_packet(packet, sizeof(packet)));
+	CHECK(!radio.is_spi_idle());
+	radio.on_tick(SimClock::ticks + 200);
+	CHECK_EQ(step, 0); /** the timeout does not steal a receive that is being drained **/
+
+	run_spi(radio);
+	CHECK_EQ(step, 1);
+	CHECK(received.has_value());
+	CHECK_EQ(received.value_or(0), sizeof(packet));
+	CHECK(std::memcmp(buffer, packet, sizeof(packet)) == 0);
+
+	/** the coroutine went on to cad(), CAD is entered once the SPI queue has run **/
+	run_spi(radio);
+	CHECK(bus.mode() == lora::Mode::CAD);
+
+	bus.channel_busy = false;
+	bus.advance(bus.cad_duration_us); /** CadDone: the flags read and the clear are queued **/
+	CHECK(bus.complete_async());
+	radio.on_spi_complete(); /** IrqFlags read **/
+	CHECK_EQ(step, 1); /** still waiting for the clear **/
+	run_spi(radio);
+	CHECK_EQ(step, 2);
+	CHECK(!activity);
+	CHECK_EQ(irq_flags_after_cad, 0); /** resumed after CadDone was cleared **/
+	CHECK(!bus.dio0());
+
+	/** plain timeout **/
+	static etl::optional<uint8_t> timed_out = 7;
+	static bool done = false;
+	auto timeout = [](Radio& radio, uint32_t deadline) -> Task {
+		timed_out = co_await radio.receive(etl::span<uint8_t>(buffer), deadline);
+		done = true;
+	};
+	radio.startReceive();
+	auto second = timeout(radio, SimClock::ticks + 100);
+	CHECK(static_cast<bool>(second));
+	radio.on_tick(SimClock::ticks + 50);
+	CHECK(!done);
+	radio.on_tick(SimClock::ticks + 100);
+	CHECK(done);
+	CHECK(!timed_out.has_value());
+
+	/** the CadDone read and clear are reserved when cad() starts: a queue filled up meanwhile cannot turn a busy
+	    channel into a clear one **/
+	static int verdict = -1;
+	auto busy_cad = [](Radio& radio) -> Task { verdict = co_await radio.cad(); };
+	auto third = busy_cad(radio);
+	CHECK(static_cast<bool>(third));
+	run_spi(radio);
+	CHECK(bus.mode() == lora::Mode::CAD);
+	int reads = 0;
+	while(radio.getReceivedDataAsync(buffer, sizeof(buffer), nullptr))
+		reads++;
+	CHECK(reads > 0);
+	bus.channel_busy = true;
+	bus.advance(bus.cad_duration_us);
+	run_spi(radio);
+	CHECK_EQ(verdict, 1);
+	CHECK(!bus.dio0());
+	CHECK(radio.is_spi_idle());
+
+	return test::result();
+}
@@ -0,0 +1,97 @@
+#include <cstring>
+#include <vector>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+#include "SX1278_Fragmentation.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	Radio* sender;
+	Radio* receiver;
+	uint8_t sender_rx[256];
+	uint8_t receiver_rx[256];
+	int sender_length = -1;
+	int receiver_length = -1;
+	int data_frames = 0;
+	int dropped = 0;
+
+	/** the air between the two radios loses every fourth DATA frame **/
+	void lossy_air(void*, const uint8_t* data, uint8_t length) {
+		if(data[0] == 0xF1 && (++data_frames % 4) == 0) {
+			dropped++;
+			return;
+		}
+		receiver->get_transport().inject_packet(data, length);
+	}
+}
+
+int main() {
+	test::SimLink<Radio> link;
+	CHECK(link.initialised);
+	sender = &link.a;
+	receiver = &link.b;
+	link.a.get_transport().on_transmit = lossy_air;
+	link.a.on_rx = [] { sender_length = sender->getReceivedData(sender_rx); };
+	link.b.on_rx = [] { receiver_length = receiver->getReceivedData(receiver_rx); };
+	const uint32_t frame_us = link.a.get_transport().tx_duration_us;
+
+	std::vector<uint8_t> blob(5000);
+	for(size_t i = 0; i < blob.size(); i++) {
+		blob[i] = static_cast<uint8_t>(i * 7 + 3);
+	}
+
+	static uint8_t memory[2 * 6000];
+	Reassembler<2> reassembler{etl::span<uint8_t>(memory, sizeof(memory)), 100, 3};
+	Fragmenter<> fragmenter;
+	CHECK(fragmenter.start(etl::span<const uint8_t>(blob.data(), blob.size()), 42));
+	CHECK_EQ(fragmenter.fragment_count(), 20U);
+
+	uint32_t now = 0;
+	bool complete = false;
+	while(!fragmenter.is_complete() && now < 100000) {
+		if(auto fragment = fragmenter.next()) {
+			link.a.startTransmit(fragment->parts);
+			link.advance(frame_us);
+			now += frame_us;
+		} else {
+			link.advance(100);
+			now += 100;
+		}
+
+		if(receiver_length > 0) {
+			auto message = reassembler.on_frame(receiver_rx, static_cast<uint8_t>(receiver_length), now);
+			receiver_length = -1;
+			if(message) {
+				complete = message->data.size() == blob.size() &&
+				           std::memcmp(message->data.data(), blob.data(), blob.size()) == 0;
+			}
+		}
+		reassembler.poll(now);
+
+		uint8_t control[fragment::max_nack_size];
+		uint8_t control_length = reassembler.next_control(control);
+		if(control_length != 0) {
+			link.b.startTransmit(control, control_length);
+			link.advance(frame_us);
+			now += frame_us;
+		}
+
+		if(sender_length > 0) {
+			fragmenter.on_frame(sender_rx, static_cast<uint8_t>(sender_length));
+			sender_length = -1;
+		}
+	}
+
+	CHECK(complete);
+	CHECK(fragmenter.is_complete()); /** the sender saw the ACK **/
+	CHECK_EQ(data_frames, 26); /** 20 fragments plus 6 re-sent, every fourth of them lost **/
+	CHECK_EQ(dropped, 6);
+
+	return test::result();
+}
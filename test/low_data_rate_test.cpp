@@ -0,0 +1,53 @@
+#include "SX1278_MockTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<MockTransport>;
+
+namespace {
+	constexpr uint8_t reg_modem_config3 = 0x26;
+
+	bool chip_ldro(Radio& radio) {
+		return radio.get_transport().registers[reg_modem_config3] & 0x08;
+	}
+}
+
+int main() {
+	Radio radio{MockTransport{}};
+	CHECK(radio.init() == Status::OK);
+	CHECK(!chip_ldro(radio)); /** SF7 / 125 kHz: 1.024 ms symbols **/
+
+	/** single setters keep the bit in step: SF12 / 125 kHz has 32.768 ms symbols **/
+	radio.set_spreading_factor(lora::SpreadingFactor::SF_12);
+	CHECK(chip_ldro(radio));
+	CHECK_EQ(radio.get_time_on_air_us(10), 991232U);
+
+	/** SF12 / 500 kHz: 8.192 ms **/
+	radio.set_bandwidth(lora::Bandwidth::BW_500_KHZ);
+	CHECK(!chip_ldro(radio));
+	CHECK_EQ(radio.get_time_on_air_us(10),
+	         lora::time_on_air_us(10, lora::SpreadingFactor::SF_12, lora::Bandwidth::BW_500_KHZ,
+	                              lora::CodingRate::CR_4_5, lora::HeaderMode::EXPLICIT, lora::PayloadCRC::ON, 8, false));
+
+	/** SF11 / 125 kHz: 16.384 ms, just over the limit **/
+	radio.set_bandwidth(lora::Bandwidth::BW_125_KHZ);
+	radio.set_spreading_factor(lora::SpreadingFactor::SF_11);
+	CHECK(chip_ldro(radio));
+
+	/** unchanged bit, no register write **/
+	auto transactions = radio.get_transport().transactions;
+	radio.set_spreading_factor(lora::SpreadingFactor::SF_11);
+	CHECK_EQ(radio.get_transport().transactions - transactions, 3U); /** ModemConfig2, DetectionThreshold, DetectOptimize **/
+
+	/** the profile switch still lands on the same value **/
+	radio.set_modem_config(lora::SpreadingFactor::SF_9, lora::Bandwidth::BW_7_8_KHZ, lora::CodingRate::CR_4_5,
+	                       lora::HeaderMode::EXPLICIT, lora::PayloadCRC::ON);
+	CHECK(chip_ldro(radio));
+	radio.set_modem_config(lora::SpreadingFactor::SF_9, lora::Bandwidth::BW_250_KHZ, lora::CodingRate::CR_4_5,
+	                       lora::HeaderMode::EXPLICIT, lora::PayloadCRC::ON);
+	CHECK(!chip_ldro(radio));
+
+	return test::result();
+}
@@ -0,0 +1,49 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	Radio* peer;
+	uint8_t received[256];
+	int received_length = -1;
+}
+
+int main() {
+	test::SimLink<Radio> link;
+	CHECK(link.initialised);
+	auto& bus = link.a.get_transport();
+	peer = &link.b;
+	link.b.on_rx = [] { received_length = peer->getReceivedData(received); };
+
+	CHECK(link.a.set_fifo_slots(2, 100));
+	uint8_t beacon[] = "BEACON#0000 ok";
+	CHECK(link.a.stage_frame(1, beacon, 14));
+
+	for(uint8_t i = 0; i < 3; i++) {
+		/** only the 4-byte counter goes over the bus: STDBY (2), FifoAddrPtr (2), burst (1 + 4), RXCONTINUOUS (2) **/
+		uint8_t counter[4] = {'0', '0', '0', static_cast<uint8_t>('1' + i)};
+		uint32_t bytes = bus.bytes;
+		CHECK(link.a.patch_frame(1, 7, counter, sizeof(counter)));
+		CHECK_EQ(bus.bytes - bytes, 11U);
+
+		CHECK(link.a.transmit_staged(1));
+		link.advance(bus.tx_duration_us);
+		CHECK_EQ(received_length, 14);
+		CHECK(std::memcmp(received, "BEACON#000", 10) == 0);
+		CHECK_EQ(received[10], '1' + i);
+		CHECK(std::memcmp(received + 11, " ok", 3) == 0);
+	}
+
+	/** patches stay inside the staged frame **/
+	CHECK(!link.a.patch_frame(1, 12, beacon, 4));
+	CHECK(!link.a.patch_frame(0, 0, beacon, 1)); /** empty slot **/
+
+	return test::result();
+}
@@ -0,0 +1,61 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	Radio* peer;
+	uint8_t received[256];
+	int received_length = -1;
+
+	/** the simulated modem takes start-up plus the real time on air from the TX write to TxDone **/
+	constexpr uint32_t modem_startup_us = 100;
+}
+
+int main() {
+	test::SimLink<Radio> link;
+	CHECK(link.initialised);
+	auto& bus = link.a.get_transport();
+	peer = &link.b;
+	link.b.on_rx = [] { received_length = peer->getReceivedData(received); };
+
+	uint8_t message[] = {'s', 'l', 'o', 't'};
+	bus.tx_duration_us = modem_startup_us + link.a.get_time_on_air_us(sizeof(message));
+
+	/** parked in FSTX with DIO0 already on TxDone: going on air is a single OpMode write **/
+	CHECK(link.a.prelock_transmit(message, sizeof(message)));
+	CHECK(bus.mode() == lora::Mode::FSTX);
+	CHECK_EQ(bus.registers[0x40] & 0xC0, 0x40);
+	uint32_t transactions = bus.transactions;
+	CHECK(link.a.transmit_prelocked());
+	CHECK_EQ(bus.transactions - transactions, 1U);
+
+	auto latency = link.a.get_tx_start_latency();
+	CHECK(latency.prelocked);
+	CHECK_EQ(latency.startup_us, 40); /** estimate: PA ramp only **/
+
+	link.advance(bus.tx_duration_us);
+	CHECK_EQ(received_length, 4);
+	CHECK(std::memcmp(received, message, sizeof(message)) == 0);
+
+	/** measured on TxDone: DIO0 time minus time on air, from the transmit_prelocked() call **/
+	CHECK_EQ(link.a.get_tx_start_latency().start_ticks, static_cast<int32_t>(modem_startup_us));
+
+	/** a cold start is estimated with the PLL lock on top, and measured the same way **/
+	SimClock::ticks += 1000;
+	link.a.startTransmit(message, sizeof(message));
+	latency = link.a.get_tx_start_latency();
+	CHECK(!latency.prelocked);
+	CHECK_EQ(latency.startup_us, 100);
+	CHECK_EQ(link.a.get_tx_done_time(), SimClock::ticks + 100 + link.a.get_time_on_air_us(sizeof(message)));
+	link.advance(bus.tx_duration_us);
+	CHECK_EQ(link.a.get_tx_start_latency().start_ticks, static_cast<int32_t>(modem_startup_us));
+
+	return test::result();
+}
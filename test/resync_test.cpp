@@ -0,0 +1,47 @@
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	int tx_done = 0;
+	int rx_done = 0;
+}
+
+int main() {
+	Radio radio{SimTransport{}};
+	CHECK(radio.init() == Status::OK);
+	auto& bus = radio.get_transport();
+	radio.startReceive();
+	radio.on_tx_done = [](const EventTime&) { tx_done++; };
+	radio.on_rx = [] { rx_done++; };
+
+	/** the chip is reconfigured behind the driver's back: SF9, BW 250 kHz, CR 4/8, implicit header, CRC on **/
+	bus.registers[static_cast<uint8_t>(lora::RegisterAddress::RegModemConfig1)] = 0x89;
+	bus.registers[static_cast<uint8_t>(lora::RegisterAddress::RegModemConfig2)] = 0x94;
+	bus.registers[static_cast<uint8_t>(lora::RegisterAddress::RegPreambleMsb)] = 0x00;
+	bus.registers[static_cast<uint8_t>(lora::RegisterAddress::RegPreambleLsb)] = 0x0C;
+	constexpr uint32_t expected = lora::time_on_air_us(10, lora::SpreadingFactor::SF_9, lora::Bandwidth::BW_250_KHZ,
+	                                                   lora::CodingRate::CR_4_8, lora::HeaderMode::IMPLICIT,
+	                                                   lora::PayloadCRC::ON, 12, false);
+	CHECK(radio.get_time_on_air_us(10) != expected);
+
+	/** ... and left in TX with TxDone pending **/
+	bus.registers[static_cast<uint8_t>(RegisterAddress::RegOpMode)] = 0x80 | static_cast<uint8_t>(lora::Mode::TX);
+	bus.registers[static_cast<uint8_t>(lora::RegisterAddress::RegIrqFlags)] = IrqFlags::TxDone;
+
+	CHECK(radio.resync() == Status::OK);
+	CHECK(radio.get_mode() == lora::Mode::TX);
+	CHECK_EQ(radio.get_time_on_air_us(10), expected);
+
+	/** DIO0 is dispatched on the resynced mode: TxDone, not RxDone **/
+	radio.on_dio0_irq();
+	CHECK_EQ(tx_done, 1);
+	CHECK_EQ(rx_done, 0);
+
+	return test::result();
+}
@@ -0,0 +1,95 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	constexpr uint8_t reg_modem_stat = 0x18;
+
+	Radio* peer;
+	Radio* sender;
+	uint8_t received[256];
+	int peer_frames = 0;
+
+	void on_peer_rx() {
+		peer->getReceivedData(received);
+		peer_frames++;
+	}
+}
+
+int main() {
+	test::SimLink<Radio> link;
+	CHECK(link.initialised);
+	auto& bus = link.a.get_transport();
+	peer = &link.b;
+	sender = &link.a;
+	link.b.on_rx = on_peer_rx;
+	link.a.on_rx = [] { sender->getReceivedData(received); };
+
+	uint8_t message[] = {'h', 'e', 'l', 'l', 'o'};
+	link.a.startTransmit(message, sizeof(message));
+	link.advance(bus.tx_duration_us);
+	CHECK_EQ(peer_frames, 1);
+
+	/** a retry re-sends the FIFO copy: status burst, STDBY, FifoAddrPtr, DIO mapping and TX, no payload upload **/
+	CHECK(link.a.is_fifo_tx_valid());
+	uint32_t transactions = bus.transactions;
+	CHECK(link.a.retransmit());
+	CHECK_EQ(bus.transactions - transactions, 5U);
+	link.advance(bus.tx_duration_us);
+	CHECK_EQ(peer_frames, 2);
+	CHECK(std::memcmp(received, message, sizeof(message)) == 0);
+
+	/** refused while a frame is on air, which is delivered intact **/
+	uint8_t longer[] = {'l', 'o', 'n', 'g', 'e', 'r'};
+	link.a.startTransmit(longer, sizeof(longer));
+	link.advance(bus.tx_duration_us / 2);
+	transactions = bus.transactions;
+	CHECK(!link.a.retransmit());
+	CHECK_EQ(bus.transactions - transactions, 0U);
+	CHECK(bus.mode() == lora::Mode::TX);
+	link.advance(bus.tx_duration_us / 2);
+	CHECK_EQ(peer_frames, 3);
+	CHECK(std::memcmp(received, longer, sizeof(longer)) == 0);
+
+	/** and while a prelocked frame waits in FSTX **/
+	CHECK(link.a.prelock_transmit(message, sizeof(message)));
+	CHECK(!link.a.retransmit());
+	CHECK(bus.mode() == lora::Mode::FSTX);
+	CHECK(link.a.transmit_prelocked());
+	link.advance(bus.tx_duration_us);
+	CHECK_EQ(peer_frames, 4);
+	CHECK(std::memcmp(received, message, sizeof(message)) == 0);
+
+	/** the peer's reply landed in the FIFO: refused, the caller has to send the payload again **/
+	uint8_t reply[] = {'a', 'c', 'k'};
+	link.b.startTransmit(reply, sizeof(reply));
+	link.advance(link.b.get_transport().tx_duration_us);
+	CHECK(!link.a.is_fifo_tx_valid());
+	CHECK(!link.a.retransmit());
+
+	/** a reception in progress (implicit header: no ValidHeader, only ModemStat) refuses the retry as well **/
+	link.a.set_header_mode(lora::HeaderMode::IMPLICIT);
+	link.b.set_header_mode(lora::HeaderMode::IMPLICIT);
+	link.a.startTransmit(message, sizeof(message));
+	link.advance(bus.tx_duration_us);
+	CHECK(link.a.is_fifo_tx_valid());
+	bus.registers[reg_modem_stat] = 0x07; /** signal detected, synchronized, RX on-going **/
+	CHECK(!link.a.retransmit());
+	CHECK(!link.a.is_fifo_tx_valid());
+	CHECK(bus.mode() == lora::Mode::RXCONTINUOUS);
+
+	/** modem clear again, the next fresh transmission can be retried **/
+	bus.registers[reg_modem_stat] = 0x10;
+	link.a.startTransmit(message, sizeof(message));
+	link.advance(bus.tx_duration_us);
+	CHECK(link.a.retransmit());
+
+	return test::result();
+}
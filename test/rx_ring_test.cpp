@@ -0,0 +1,103 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	/** Puts a packet on the air for the radio and runs the FIFO drain to completion **/
+	void deliver(Radio& radio, const uint8_t* data, uint8_t length, bool crc_error = false) {
+		auto& bus = radio.get_transport();
+		CHECK(bus.inject_packet(data, length, 10, 100, crc_error));
+#ifdef SX1278_SPI_DMA
+		while(bus.complete_dma())
+			radio.on_spi_complete();
+#endif
+		/** IRQ flags cleared, so DIO0 can rise for the next packet **/
+		CHECK(!bus.dio0());
+	}
+}
+
+int main() {
+	Radio radio{SimTransport{}};
+	CHECK(radio.init() == Status::OK);
+	auto& bus = radio.get_transport();
+#ifdef SX1278_SPI_DMA
+	bus.defer_dma = true;
+#endif
+	test::wire_dio0(radio);
+	radio.startReceive();
+	auto& ring = radio.rx_ring();
+
+	/** 7 packets into 4 slots: the first 4 are kept, the other 3 counted **/
+	uint32_t arrival[7];
+	for(uint8_t i = 0; i < 7; i++) {
+		uint8_t payload[] = {'P', static_cast<uint8_t>('0' + i), i, i, i};
+		bus.advance(1000);
+		arrival[i] = SimClock::now();
+		deliver(radio, payload, static_cast<uint8_t>(3 + i % 3), i == 1);
+	}
+	CHECK_EQ(ring.size(), 4);
+	CHECK_EQ(ring.overflows(), 3U);
+	CHECK_EQ(ring.drops(), 0U);
+
+	uint8_t crc_errors = 0;
+	for(uint8_t i = 0; i < 4; i++) {
+		const RxPacket* packet = ring.front();
+		CHECK(packet != nullptr);
+		if(packet == nullptr)
+			break;
+		CHECK_EQ(packet->length, 3 + i % 3);
+		CHECK_EQ(packet->data[0], 'P');
+		CHECK_EQ(packet->data[1], '0' + i);
+		CHECK_EQ(packet->status.snr, 40);
+		CHECK_EQ(packet->time.done, arrival[i]);
+		CHECK_EQ(packet->crc_error(), i == 1);
+		crc_errors += packet->crc_error();
+		ring.pop();
+	}
+	CHECK_EQ(crc_errors, 1);
+	CHECK(ring.front() == nullptr);
+
+	/** DIO0 still works after the overflows **/
+	const uint8_t after[] = {'A', 'F', 'T', 'E', 'R'};
+	deliver(radio, after, sizeof(after));
+	CHECK(ring.front() != nullptr && ring.front()->length == sizeof(after) &&
+	      std::memcmp(ring.front()->data, after, sizeof(after)) == 0);
+	ring.pop();
+
+	/** a full frame reaches the last line of the slot payload, the metadata behind it survives the drain **/
+	uint8_t full[255];
+	for(uint16_t i = 0; i < sizeof(full); i++)
+		full[i] = static_cast<uint8_t>(i);
+	deliver(radio, full, sizeof(full));
+	CHECK(ring.front() != nullptr && ring.front()->length == sizeof(full) && ring.front()->status.snr == 40 &&
+	      std::memcmp(ring.front()->data, full, sizeof(full)) == 0);
+	ring.pop();
+
+	/** implicit header: the length is the one configured in RegPayloadLength **/
+	radio.set_header_mode(lora::HeaderMode::IMPLICIT);
+	bus.registers[static_cast<uint8_t>(lora::RegisterAddress::RegPayloadLength)] = 4;
+	const uint8_t implicit[] = {'I', 'M', 'P', 'L'};
+	deliver(radio, implicit, sizeof(implicit));
+	CHECK(ring.front() != nullptr && ring.front()->length == sizeof(implicit) &&
+	      std::memcmp(ring.front()->data, implicit, sizeof(implicit)) == 0);
+	ring.pop();
+
+	/** without a length the frame cannot be read: dropped and counted, DIO0 released all the same **/
+	bus.registers[static_cast<uint8_t>(lora::RegisterAddress::RegPayloadLength)] = 0;
+	deliver(radio, implicit, sizeof(implicit));
+	CHECK(ring.front() == nullptr);
+	CHECK_EQ(ring.drops(), 1U);
+
+	bus.registers[static_cast<uint8_t>(lora::RegisterAddress::RegPayloadLength)] = 4;
+	deliver(radio, implicit, sizeof(implicit));
+	CHECK_EQ(ring.size(), 1);
+
+	return test::result();
+}
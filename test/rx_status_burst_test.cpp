@@ -0,0 +1,75 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	Radio* radio_under_test;
+	uint8_t received[256];
+	int received_length = -1;
+	uint32_t rx_transactions = 0;
+}
+
+int main() {
+	Radio radio{SimTransport{}};
+	CHECK(radio.init() == Status::OK);
+	auto& bus = radio.get_transport();
+	radio_under_test = &radio;
+	test::wire_dio0(radio);
+	radio.startReceive();
+
+	/** blocking: status burst, FIFO pointer, FIFO burst and IRQ clear **/
+	radio.on_rx = [] {
+		uint32_t transactions = radio_under_test->get_transport().transactions;
+		received_length = radio_under_test->getReceivedData(received);
+		rx_transactions = radio_under_test->get_transport().transactions - transactions;
+	};
+	const uint8_t hello[] = {'h', 'e', 'l', 'l', 'o'};
+	CHECK(bus.inject_packet(hello, sizeof(hello), -2, 90));
+	CHECK_EQ(received_length, static_cast<int>(sizeof(hello)));
+	CHECK(std::memcmp(received, hello, sizeof(hello)) == 0);
+	CHECK_EQ(rx_transactions, 4U);
+	CHECK(!bus.dio0());
+	/** SNR and RSSI came with the same burst **/
+	CHECK_EQ(radio.get_packet_status().snr, -8);
+
+	/** asynchronous, run inline and with every transfer left to the SPI interrupt: the same 4 transactions **/
+	radio.on_rx = nullptr;
+	for(bool deferred : {false, true}) {
+		bus.defer_async = deferred;
+		const uint8_t async[] = {'a', 's', 'y', 'n', 'c', '!'};
+		CHECK(bus.inject_packet(async, sizeof(async)));
+
+		received_length = -1;
+		uint32_t transactions = bus.transactions;
+		CHECK(radio.getReceivedDataAsync(received, 255, [](uint8_t*, uint8_t length) {
+			received_length = length;
+		}));
+		/** mode writes queued behind the status burst cannot take the slots of the drain **/
+		int queued = 0;
+		while(deferred && radio.startReceiveAsync())
+			queued++;
+		while(bus.complete_async())
+			radio.on_spi_complete();
+		CHECK_EQ(bus.transactions - transactions, 4U + queued);
+		CHECK_EQ(received_length, static_cast<int>(sizeof(async)));
+		CHECK(std::memcmp(received, async, sizeof(async)) == 0);
+		CHECK(!bus.dio0());
+		radio.startReceive();
+	}
+
+	/** nothing waiting: 0 bytes, and the IRQ flags say there was no RxDone **/
+	bus.defer_async = false;
+	received_length = -1;
+	CHECK(radio.getReceivedDataAsync(received, 255, [](uint8_t*, uint8_t length) { received_length = length; }));
+	CHECK_EQ(received_length, 0);
+	CHECK(!(radio.get_rx_irq_flags() & IrqFlags::RxDone));
+
+	return test::result();
+}
@@ -0,0 +1,46 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	Radio* peer;
+	uint8_t received[256];
+	int received_length = -1;
+}
+
+int main() {
+	test::SimLink<Radio> link;
+	CHECK(link.initialised);
+	auto& bus = link.a.get_transport();
+	peer = &link.b;
+	link.b.on_rx = [] { received_length = peer->getReceivedData(received); };
+
+	/** header, an empty segment and a payload stream into the FIFO as one frame, one FIFO burst **/
+	const uint8_t header[] = {'H', 'D', 'R', ':'};
+	const uint8_t payload[] = {'p', 'a', 'y'};
+	etl::span<const uint8_t> segments[] = {header, {}, payload};
+	uint32_t transactions = bus.transactions;
+	CHECK(link.a.startTransmit(segments).has_value());
+	CHECK_EQ(bus.transactions - transactions, 6U); /** STDBY, FifoAddrPtr, PayloadLength, FIFO, DIO mapping, TX **/
+	link.advance(bus.tx_duration_us);
+
+	CHECK_EQ(received_length, 7);
+	CHECK(std::memcmp(received, "HDR:pay", 7) == 0);
+
+	/** over one frame: nothing is sent **/
+	static uint8_t big[200];
+	etl::span<const uint8_t> too_long[] = {big, big};
+	transactions = bus.transactions;
+	CHECK(!link.a.startTransmit(too_long).has_value());
+	CHECK_EQ(bus.transactions - transactions, 0U);
+	CHECK(bus.mode() == lora::Mode::RXCONTINUOUS);
+
+	return test::result();
+}
@@ -0,0 +1,55 @@
+#ifndef KALMAN_ELECTRONICS_SX1278_DRIVER_TEST_SIM_LINK_HPP
+#define KALMAN_ELECTRONICS_SX1278_DRIVER_TEST_SIM_LINK_HPP
+
+#include <cstdint>
+
+#include "SX1278_SimTransport.hpp"
+
+namespace test {
+	/** Forwards the radio's DIO0 rising edges to its driver **/
+	template <typename Radio>
+	void wire_dio0(Radio& radio) {
+		auto& bus = radio.get_transport();
+		bus.on_dio0 = [](void* context) { static_cast<Radio*>(context)->on_dio0_irq(); };
+		bus.dio0_context = &radio;
+	}
+
+	/** Delivers every frame `from` transmits to `to` **/
+	template <typename Radio>
+	void wire_air(Radio& from, Radio& to) {
+		auto& bus = from.get_transport();
+		bus.on_transmit = [](void* context, const uint8_t* data, uint8_t length) {
+			static_cast<Radio*>(context)->get_transport().inject_packet(data, length);
+		};
+		bus.transmit_context = &to;
+	}
+
+	/** Two simulated radios in range of each other, both initialised and listening **/
+	template <typename Radio>
+	struct SimLink {
+		Radio a{radio::sx1278::SimTransport{}};
+		Radio b{radio::sx1278::SimTransport{}};
+		bool initialised;
+
+		SimLink() {
+			initialised = a.init() == radio::sx1278::Status::OK && b.init() == radio::sx1278::Status::OK;
+			wire_dio0(a);
+			wire_dio0(b);
+			wire_air(a, b);
+			wire_air(b, a);
+			a.startReceive();
+			b.startReceive();
+		}
+
+		SimLink(const SimLink&) = delete;
+		SimLink& operator=(const SimLink&) = delete;
+
+		/** Moves the shared SimClock forward and lets both radios catch up **/
+		void advance(uint32_t us) {
+			a.get_transport().advance(us);
+			b.get_transport().update();
+		}
+	};
+}
+
+#endif //KALMAN_ELECTRONICS_SX1278_DRIVER_TEST_SIM_LINK_HPP
@@ -0,0 +1,63 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	Radio* receiver;
+	uint8_t received[256];
+	int received_length = -1;
+
+	void on_rx() {
+		received_length = receiver->getReceivedData(received);
+	}
+}
+
+int main() {
+	test::SimLink<Radio> link;
+	auto& bus_a = link.a.get_transport();
+	auto& bus_b = link.b.get_transport();
+	receiver = &link.b;
+	link.b.on_rx = on_rx;
+
+	/** init switches to LoRa (only possible in SLEEP) and leaves the radio listening **/
+	CHECK(link.initialised);
+	CHECK(bus_a.is_lora());
+	CHECK(bus_b.is_lora());
+	CHECK(bus_a.mode() == lora::Mode::RXCONTINUOUS);
+
+	for(uint8_t k = 0; k < 3; k++) {
+		uint8_t message[] = {'h', 'i', static_cast<uint8_t>('0' + k)};
+		received_length = -1;
+		link.a.startTransmit(message, sizeof(message));
+		CHECK(bus_a.mode() == lora::Mode::TX);
+
+		link.advance(bus_a.tx_duration_us);
+		CHECK_EQ(received_length, 3);
+		CHECK(std::memcmp(received, message, sizeof(message)) == 0);
+
+		/** TxDone is cleared before going back to RX, so DIO0 is low and the next RxDone raises a new edge **/
+		CHECK(bus_a.mode() == lora::Mode::RXCONTINUOUS);
+		CHECK(!bus_a.dio0());
+		CHECK(bus_b.mode() == lora::Mode::RXCONTINUOUS);
+		CHECK(!bus_b.dio0());
+	}
+
+	/** the former sender still receives **/
+	static Radio* sender = &link.a;
+	static int reply_length = -1;
+	link.a.on_rx = [] { reply_length = sender->getReceivedData(received); };
+	uint8_t reply[] = {'o', 'k'};
+	link.b.startTransmit(reply, sizeof(reply));
+	link.advance(bus_b.tx_duration_us);
+	CHECK_EQ(reply_length, 2);
+	CHECK(std::memcmp(received, reply, sizeof(reply)) == 0);
+
+	return test::result();
+}
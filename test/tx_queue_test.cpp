@@ -0,0 +1,55 @@
+#include <cstring>
+
+#include "SX1278_SimTransport.hpp"
+#include "SX1278.hpp"
+
+#include "check.hpp"
+#include "sim_link.hpp"
+
+using namespace radio::sx1278;
+using Radio = SX1278<SimTransport>;
+
+namespace {
+	Radio* receiver;
+	uint8_t received[5][4];
+	int received_count = 0;
+	int tx_done_count = 0;
+
+	void on_rx() {
+		if(received_count < 5)
+			receiver->getReceivedData(received[received_count]);
+		received_count++;
+	}
+}
+
+int main() {
+	test::SimLink<Radio> link;
+	CHECK(link.initialised);
+	receiver = &link.b;
+	link.b.on_rx = on_rx;
+	link.a.on_tx_done = [](const EventTime&) { tx_done_count++; };
+
+	/** five frames queued at once go out back to back, each started from the previous TxDone **/
+	static uint8_t frames[5][3];
+	for(uint8_t k = 0; k < 5; k++) {
+		frames[k][0] = 'f';
+		frames[k][1] = static_cast<uint8_t>('0' + k);
+		frames[k][2] = '!';
+		CHECK(link.a.queueTransmit(frames[k], sizeof(frames[k])));
+	}
+	CHECK_EQ(link.a.tx_queue_size(), 4); /** the first one is already on air **/
+
+	for(int i = 0; i < 10; i++) {
+		link.advance(link.a.get_transport().tx_duration_us);
+	}
+
+	CHECK_EQ(received_count, 5);
+	CHECK_EQ(tx_done_count, 5);
+	for(int k = 0; k < 5; k++) {
+		CHECK(std::memcmp(received[k], frames[k], sizeof(frames[k])) == 0);
+	}
+	CHECK_EQ(link.a.tx_queue_size(), 0);
+	CHECK(link.a.get_transport().mode() == lora::Mode::RXCONTINUOUS);
+
+	return test::result();
+}